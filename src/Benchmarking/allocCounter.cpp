@@ -0,0 +1,57 @@
+#include "allocCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<std::size_t> allocations{0};
+    std::atomic<std::size_t> liveBytes{0};
+    std::atomic<std::size_t> peakBytes{0};
+
+    // Each block carries its size in a header so delete can account for it.
+    // The header is a full max_align_t so the returned pointer stays aligned.
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    void notePeak(const std::size_t live) {
+        for (std::size_t cur = peakBytes.load(std::memory_order_relaxed);
+             live > cur && !peakBytes.compare_exchange_weak(cur, live, std::memory_order_relaxed);) {}
+    }
+}
+
+std::size_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t liveAllocatedBytes() {
+    return liveBytes.load(std::memory_order_relaxed);
+}
+
+std::size_t peakAllocatedBytes() {
+    return peakBytes.load(std::memory_order_relaxed);
+}
+
+void resetPeakAllocatedBytes() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// The array and nothrow forms of new/delete forward to these by default.
+void* operator new(const std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* p = static_cast<unsigned char*>(std::malloc(HEADER + size))) {
+        *reinterpret_cast<std::size_t*>(p) = size;
+        notePeak(liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+        return p + HEADER;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    auto* block = static_cast<unsigned char*>(p) - HEADER;
+    liveBytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
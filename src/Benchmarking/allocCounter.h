@@ -0,0 +1,17 @@
+#ifndef MOVIERECOMMENDER_ALLOCCOUNTER_H
+#define MOVIERECOMMENDER_ALLOCCOUNTER_H
+#include <cstddef>
+
+// Counters kept by the replacement global operator new/delete in
+// allocCounter.cpp. Only allocations made through operator new are seen.
+
+// Number of calls to operator new so far.
+std::size_t allocationCount();
+
+// Bytes currently allocated, and the high-water mark since the last reset.
+std::size_t liveAllocatedBytes();
+std::size_t peakAllocatedBytes();
+void resetPeakAllocatedBytes();
+
+
+#endif //MOVIERECOMMENDER_ALLOCCOUNTER_H
\ No newline at end of file
@@ -2,13 +2,32 @@
 #define MOVIERECOMMENDER_BENCHMARK_H
 
 #include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <initializer_list>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>
 #include <vector>
 #include <iomanip>
 #include "Graph/graph.h"
+#include "Graph/buildKNNGraph.h"
+#include "Graph/buildNNDescentGraph.h"
+#include "Graph/loadgraph.h"
+#include "Graph/savegraph.h"
+#include "Graph/binaryGraph.h"
 #include "D_alg/dAlg.h"
 #include "D_alg/topKRecommendations.h"
+#include "D_alg/recommendationCache.h"
+#include "D_alg/topKTable.h"
 #include "../Heap/heapTopK.h"
+#include "../MoviesUtil/similarityBatch.h"
+#include "../MovieLens/movieLens.h"
+#include "allocCounter.h"
+#include "mockTmdbServer.h"
+#include "../ImdbAPI/ImdbAPI.h"
+#include "../MoviesRepo/MoviesRepository.h"
 
 class Benchmark {
 public:
@@ -16,42 +35,888 @@ public:
         double time_ms;
         std::vector<int> recommendations;
         size_t memory_usage_kb;
+        size_t graph_copies = 0;
+        int nodes_settled = 0;
     };
 
-    static void compareAlgorithms(Graph& graph, int sourceMovieIndex, int k = 10) {
+    static void compareAlgorithms(const Graph& graph, int sourceMovieIndex, int k = 10) {
         std::cout << "\n=== ALGORITHM COMPARISON ===\n";
-        std::cout << "Source Movie: " << graph.getMovies()[sourceMovieIndex].name << "\n";
+        std::cout << "Source Movie: " << graph.getMovie(sourceMovieIndex).name << "\n";
         std::cout << "K: " << k << "\n";
-        std::cout << "Total Movies: " << graph.getMovies().size() << "\n\n";
+        std::cout << "Total Movies: " << graph.size() << "\n\n";
 
         auto graphResult = benchmarkGraphApproach(graph, sourceMovieIndex, k);
 
+        auto earlyResult = benchmarkGraphTopKApproach(graph, sourceMovieIndex, k);
+
         auto heapResult = benchmarkHeapApproach(graph, sourceMovieIndex, k);
 
-        printComparison(graphResult, heapResult, graph, sourceMovieIndex, k);
+        printComparison(graphResult, earlyResult, heapResult, graph, sourceMovieIndex, k);
+
+        compareQueryAllocations(graph, sourceMovieIndex, k);
+
+        compareRecommendationCache(graph, k);
+
+        compareTopKTable(graph, k);
+    }
+
+    static void compareDijkstraQueues(const Graph& graph, int k = 10) {
+        const int n = graph.size();
+        const int sources = std::min(n, 1000);
+
+        std::cout << "\nDIJKSTRA PRIORITY QUEUES (" << sources << " sources):\n";
+        std::cout << "  Queue          top-" << k << " ms/query   full ms/query   Same distances\n";
+
+        BasicDijkstraWorkspace<BinaryHeapQueue> reference;
+        std::vector<std::vector<double>> expected(sources);
+        for (int s = 0; s < sources; ++s) {
+            expected[s] = dijkstraTopK(s, graph, n, reference).distance;
+        }
+
+        benchmarkQueue<BinaryHeapQueue>("Binary heap", graph, k, expected);
+        benchmarkQueue<RadixHeapQueue>("Radix heap", graph, k, expected);
+        benchmarkQueue<BucketQueue>("Bucket (Dial)", graph, k, expected);
+    }
+
+    static void compareQueryAllocations(const Graph& graph, int sourceMovieIndex, int k = 10) {
+        constexpr int QUERIES = 1000;
+        const int n = graph.size();
+
+        std::cout << "\nPER-QUERY ALLOCATIONS (" << QUERIES << " top-" << k << " queries):\n";
+
+        size_t before = allocationCount();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int q = 0; q < QUERIES; ++q) {
+            auto res = dijkstraTopK((sourceMovieIndex + q) % n, graph, k);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        const size_t freshAllocs = allocationCount() - before;
+        double freshMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        DijkstraWorkspace ws;
+        for (int q = 0; q < QUERIES; ++q) {
+            dijkstraTopK((sourceMovieIndex + q) % n, graph, k, ws);
+        }
+
+        before = allocationCount();
+        start = std::chrono::high_resolution_clock::now();
+        for (int q = 0; q < QUERIES; ++q) {
+            dijkstraTopK((sourceMovieIndex + q) % n, graph, k, ws);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        const size_t workspaceAllocs = allocationCount() - before;
+        double workspaceMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::cout << "  Fresh buffers: " << std::fixed << std::setprecision(2)
+                  << (static_cast<double>(freshAllocs) / QUERIES) << " allocs/query, "
+                  << std::setprecision(4) << (freshMs / QUERIES) << " ms/query\n";
+        std::cout << "  Workspace:     " << std::fixed << std::setprecision(2)
+                  << (static_cast<double>(workspaceAllocs) / QUERIES) << " allocs/query, "
+                  << std::setprecision(4) << (workspaceMs / QUERIES) << " ms/query\n";
+    }
+
+    // A skewed query stream (source rank r drawn with weight 1/r, like a few
+    // popular titles taking most lookups) with and without the result cache.
+    static void compareRecommendationCache(const Graph& graph, int k = 10) {
+        constexpr int QUERIES = 20000;
+        const int n = graph.size();
+        if (n == 0) return;
+
+        std::mt19937 rng(7);
+        std::vector<double> weights(n);
+        for (int r = 0; r < n; ++r) weights[r] = 1.0 / (r + 1);
+        std::discrete_distribution<int> rank(weights.begin(), weights.end());
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::shuffle(order, rng);
+        std::vector<int> queries(QUERIES);
+        for (int& q : queries) q = order[rank(rng)];
+
+        std::cout << "\nRECOMMENDATION CACHE (" << QUERIES << " skewed top-" << k << " queries):\n";
+
+        DijkstraWorkspace ws;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const int q : queries) dijkstraTopK(q, graph, k, ws);
+        auto end = std::chrono::high_resolution_clock::now();
+        const double uncachedMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        RecommendationCache cache;
+        start = std::chrono::high_resolution_clock::now();
+        for (const int q : queries) cache.topK(q, graph, k, ws);
+        end = std::chrono::high_resolution_clock::now();
+        const double cachedMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        const auto& stats = cache.getStats();
+        std::cout << "  Uncached: " << std::fixed << std::setprecision(4) << (uncachedMs / QUERIES) << " ms/query\n";
+        std::cout << "  Cached:   " << (cachedMs / QUERIES) << " ms/query, hit rate "
+                  << std::setprecision(1) << (100.0 * stats.hitRate()) << "%, "
+                  << stats.entries << " entries, "
+                  << std::setprecision(2) << (static_cast<double>(stats.bytes) / (1024.0 * 1024.0)) << " MiB\n";
+    }
+
+    // Batch job for the precomputed top-k table, then table lookups against
+    // Dijkstra on the same sources. The table file is removed afterwards.
+    static void compareTopKTable(const Graph& graph, int k = 10) {
+        constexpr int QUERIES = 1000;
+        const int n = graph.size();
+        if (n == 0) return;
+        const std::string path = "benchmark_topk.tmp";
+
+        std::cout << "\nPRECOMPUTED TOP-" << k << " TABLE (" << n << " sources):\n";
+        TopKTableBuildStats stats;
+        for (const unsigned threads : {1u, defaultThreadCount()}) {
+            stats = buildTopKTable(graph, k, path, threads);
+            std::cout << "  Build, " << std::setw(2) << threads << " threads: " << std::fixed << std::setprecision(1)
+                      << stats.ms << " ms, " << static_cast<long long>(stats.sourcesPerSecond()) << " sources/s\n";
+            if (threads == 1 && defaultThreadCount() == 1) break;
+        }
+
+        const TopKTable table(path);
+        std::size_t mismatches = 0;
+        DijkstraWorkspace ws;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int q = 0; q < QUERIES; ++q) dijkstraTopK(q % n, graph, k, ws);
+        auto end = std::chrono::high_resolution_clock::now();
+        const double searchMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::size_t checksum = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (int q = 0; q < QUERIES; ++q) {
+            for (const TopKTableEntry& e : table.row(q % n)) checksum += static_cast<std::size_t>(e.node);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        const double tableMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        for (int q = 0; q < QUERIES; ++q) {
+            const auto& expected = dijkstraTopK(q % n, graph, k, ws).nodes;
+            const auto row = table.row(q % n);
+            if (row.size() != expected.size()
+                || !std::ranges::equal(row, expected, {}, &TopKTableEntry::node)) {
+                ++mismatches;
+            }
+        }
+
+        std::cout << "  File: " << std::setprecision(2) << (static_cast<double>(stats.bytes) / (1024.0 * 1024.0))
+                  << " MiB\n";
+        std::cout << "  Dijkstra: " << std::setprecision(6) << (searchMs / QUERIES) << " ms/query\n";
+        std::cout << "  Table:    " << (tableMs / QUERIES) << " ms/query (checksum " << checksum << "), "
+                  << (mismatches == 0 ? "same results" : "MISMATCHED results") << "\n";
+        std::filesystem::remove(path);
+    }
+
+    // The same TmdbAPI workload (popular pages, detail lookups, searches)
+    // against the local mock server, with a new connection per request and
+    // with pooled handles sharing connections.
+    static void compareTmdbConnections(int poolSize = 400, int lookups = 40, int searches = 10) {
+        std::cout << "\n=== TMDB CONNECTION REUSE (local mock server) ===\n";
+        std::cout << "Workload: " << poolSize << " popular movies, " << lookups << " lookups, "
+                  << searches << " searches\n\n";
+        std::cout << "  Mode                 Requests   Connections   Handles   Time (ms)\n";
+
+        MockTmdbServer server;
+        for (const bool reuse : {false, true}) {
+            server.resetCounters();
+            TmdbApiOptions options;
+            options.baseUrl = server.baseUrl();
+            options.reuseConnections = reuse;
+            const TmdbAPI api("mock-key", options);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            const auto movies = api.fetchPopularMovies(poolSize);
+            for (int i = 0; i < lookups && !movies.empty(); ++i) {
+                (void)api.fetchMovieById(movies[i % movies.size()].tmdbId);
+            }
+            for (int i = 0; i < searches; ++i) {
+                (void)api.searchMoviesByTitle("mock " + std::to_string(i));
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+
+            std::cout << "  " << std::left << std::setw(20) << (reuse ? "Pooled + shared" : "Handle per request")
+                      << std::right << std::setw(9) << server.requests()
+                      << std::setw(14) << server.connections()
+                      << std::setw(10) << api.curlHandlesCreated()
+                      << std::setw(12) << std::fixed << std::setprecision(1)
+                      << std::chrono::duration<double, std::milli>(end - start).count() << "\n";
+        }
+    }
+
+    // fetchPopularMovies with 1 (serial) and more pages in flight against the
+    // mock server with a fixed per-response delay. Every run must return the
+    // serial result, in the same order.
+    static void compareTmdbPageFetching(int poolSize = 2000, int latencyMs = 20) {
+        std::cout << "\n=== TMDB POPULAR PAGES IN FLIGHT (mock latency " << latencyMs << " ms) ===\n";
+        std::cout << "Pool: " << poolSize << " movies, " << (poolSize + 19) / 20 << " pages\n\n";
+        std::cout << "  In flight   Time (ms)   Speedup   Connections   Same result\n";
+
+        MockTmdbServer server;
+        server.setLatency(std::chrono::milliseconds(latencyMs));
+        std::vector<int> expected;
+        double serialMs = 0.0;
+        for (const int inFlight : {1, 4, 8, 16, 32}) {
+            server.resetCounters();
+            TmdbApiOptions options;
+            options.baseUrl = server.baseUrl();
+            options.maxConcurrentRequests = inFlight;
+            const TmdbAPI api("mock-key", options);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            const auto movies = api.fetchPopularMovies(poolSize);
+            auto end = std::chrono::high_resolution_clock::now();
+            const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+            std::vector<int> ids;
+            for (const auto& m : movies) ids.push_back(m.tmdbId);
+            if (inFlight == 1) {
+                expected = ids;
+                serialMs = ms;
+            }
+
+            std::cout << "  " << std::setw(9) << inFlight
+                      << std::setw(12) << std::fixed << std::setprecision(1) << ms
+                      << std::setw(9) << std::setprecision(2) << (serialMs / ms) << "x"
+                      << std::setw(14) << server.connections()
+                      << std::setw(14) << (ids == expected ? "yes" : "NO") << "\n";
+        }
+    }
+
+    // The option 1 TMDb workload run three times against the mock server with
+    // a per-response delay: with an empty response cache, with it filled, and
+    // offline-only. Requests counts what actually reached the server.
+    static void compareTmdbResponseCache(int poolSize = 2000, int lookups = 40, int latencyMs = 20) {
+        std::cout << "\n=== TMDB RESPONSE CACHE (mock latency " << latencyMs << " ms) ===\n";
+        std::cout << "Workload: " << poolSize << " popular movies, " << lookups << " lookups\n\n";
+        std::cout << "  Run            Time (ms)   Requests   Hit rate   Same result\n";
+
+        const std::string dir = "benchmark_tmdb_cache.tmp";
+        std::filesystem::remove_all(dir);
+        MockTmdbServer server;
+        server.setLatency(std::chrono::milliseconds(latencyMs));
+
+        std::vector<int> expected;
+        const std::pair<const char*, HttpCacheMode> runs[] = {
+            {"Cold", HttpCacheMode::Normal}, {"Warm", HttpCacheMode::Normal}, {"Offline only", HttpCacheMode::OfflineOnly}
+        };
+        for (const auto& [name, mode] : runs) {
+            server.resetCounters();
+            TmdbApiOptions options;
+            options.baseUrl = server.baseUrl();
+            options.cacheDir = dir;
+            options.cacheMode = mode;
+            const TmdbAPI api("mock-key", options);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            const auto movies = api.fetchPopularMovies(poolSize);
+            std::vector<int> ids;
+            for (const auto& m : movies) ids.push_back(m.tmdbId);
+            for (int i = 0; i < lookups && !movies.empty(); ++i) {
+                ids.push_back(api.fetchMovieById(movies[i % movies.size()].tmdbId).tmdbId);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            if (expected.empty()) expected = ids;
+
+            std::cout << "  " << std::left << std::setw(13) << name << std::right
+                      << std::setw(11) << std::fixed << std::setprecision(1)
+                      << std::chrono::duration<double, std::milli>(end - start).count()
+                      << std::setw(11) << server.requests()
+                      << std::setw(10) << std::setprecision(1) << (100.0 * api.cacheStats()->hitRate()) << "%"
+                      << std::setw(14) << (ids == expected ? "yes" : "NO") << "\n";
+        }
+        std::filesystem::remove_all(dir);
+    }
+
+    // Query threads resolving overlapping batches of movie ids: straight
+    // fetchMovieById calls, a shared MoviesRepository hit one id at a time,
+    // and the same repository asked for each batch with getMovies.
+    static void compareMoviesRepository(int threads = 4, int rounds = 3, int batch = 50, int latencyMs = 20) {
+        std::cout << "\n=== MOVIES REPOSITORY (mock latency " << latencyMs << " ms) ===\n";
+        std::cout << "Workload: " << threads << " threads x " << rounds << " batches of " << batch
+                  << " ids from a pool of 200\n\n";
+        std::cout << "  Run                     Time (ms)   Requests   Hit rate   Same result\n";
+
+        auto batchIds = [&](const int t, const int r) {
+            std::vector<int> ids(batch);
+            for (int i = 0; i < batch; ++i) ids[i] = (t * 17 + r * 31 + i * 7) % 200 + 1;
+            return ids;
+        };
+
+        MockTmdbServer server;
+        server.setLatency(std::chrono::milliseconds(latencyMs));
+        TmdbApiOptions options;
+        options.baseUrl = server.baseUrl();
+        TmdbAPI api("mock-key", options);
+
+        std::vector<std::vector<int>> expected;
+        for (const char* name : {"fetchMovieById", "Repository getMovie", "Repository getMovies"}) {
+            const std::string run = name;
+            server.resetCounters();
+            MoviesRepository repo(api);
+            std::vector<std::vector<int>> seen(threads);
+            std::vector<std::string> errors(threads);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                // An exception escaping a std::thread would terminate the
+                // program, so each worker keeps its own error.
+                workers.emplace_back([&, t] {
+                    try {
+                        for (int r = 0; r < rounds; ++r) {
+                            const auto ids = batchIds(t, r);
+                            if (run == "Repository getMovies") {
+                                for (const auto& m : repo.getMovies(ids)) seen[t].push_back(m.tmdbId);
+                                continue;
+                            }
+                            for (const int id : ids) {
+                                seen[t].push_back(run == "fetchMovieById" ? api.fetchMovieById(id).tmdbId
+                                                                         : repo.getMovie(id).tmdbId);
+                            }
+                        }
+                    } catch (const std::exception& e) {
+                        errors[t] = e.what();
+                    }
+                });
+            }
+            for (auto& w : workers) w.join();
+            auto end = std::chrono::high_resolution_clock::now();
+
+            if (const auto failed = std::ranges::find_if(errors, [](const auto& e) { return !e.empty(); });
+                failed != errors.end()) {
+                std::cout << "  " << std::left << std::setw(22) << name << std::right
+                          << "  failed: " << *failed << "\n";
+                continue;
+            }
+            if (expected.empty()) expected = seen;
+
+            std::cout << "  " << std::left << std::setw(22) << name << std::right
+                      << std::setw(11) << std::fixed << std::setprecision(1)
+                      << std::chrono::duration<double, std::milli>(end - start).count()
+                      << std::setw(11) << server.requests()
+                      << std::setw(10) << std::setprecision(1) << (100.0 * repo.getStats().hitRate()) << "%"
+                      << std::setw(14) << (seen == expected ? "yes" : "NO") << "\n";
+        }
+    }
+
+    static void compareKNNBuildThreads(std::span<const Movie> movies, int k = 20) {
+        std::cout << "\n=== KNN GRAPH BUILD SCALING ===\n";
+        std::cout << "Movies: " << movies.size() << "  K: " << k << "\n\n";
+        std::cout << "  Threads     Time (ms)   Speedup   Matches serial\n";
+
+        Graph serial;
+        double serialMs = 0.0;
+
+        for (const unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+            Graph g;
+            for (const auto& m : movies) g.addMovie(m);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            buildKNNGraph(g, k, threads);
+            auto end = std::chrono::high_resolution_clock::now();
+            double duration = std::chrono::duration<double, std::milli>(end - start).count();
+
+            if (threads == 1) {
+                serialMs = duration;
+                serial = std::move(g);
+            }
+            const bool same = threads == 1 || sameEdges(serial, g);
+
+            std::cout << "  " << std::setw(7) << threads
+                      << "  " << std::setw(12) << std::fixed << std::setprecision(3) << duration
+                      << "  " << std::setw(7) << std::setprecision(2) << (serialMs / duration) << "x"
+                      << "  " << (same ? "yes" : "NO") << "\n";
+        }
+    }
+
+    static void compareKNNPruning(std::span<const Movie> movies, int k = 20) {
+        std::cout << "\n=== GENRE-INDEX CANDIDATE PRUNING ===\n";
+
+        Graph full;
+        Graph pruned;
+        for (const auto& m : movies) {
+            full.addMovie(m);
+            pruned.addMovie(m);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        const auto fullStats = buildKNNGraph(full, k, defaultThreadCount(), false);
+        auto end = std::chrono::high_resolution_clock::now();
+        double fullMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        const auto prunedStats = buildKNNGraph(pruned, k, defaultThreadCount(), true);
+        end = std::chrono::high_resolution_clock::now();
+        double prunedMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::cout << "  All pairs:   " << fullStats.pairsScored << " scored, "
+                  << std::fixed << std::setprecision(3) << fullMs << " ms\n";
+        std::cout << "  Genre index: " << prunedStats.pairsScored << " scored, "
+                  << std::fixed << std::setprecision(3) << prunedMs << " ms\n";
+        std::cout << "  Pruned per row:      " << std::fixed << std::setprecision(1)
+                  << prunedStats.prunedPerRow() << " of " << (movies.size() - 1) << "\n";
+        std::cout << "  Candidates per row:  " << prunedStats.minCandidates
+                  << " min, " << prunedStats.maxCandidates << " max\n";
+        std::cout << "  Identical graph:     " << (sameEdges(full, pruned) ? "yes" : "NO") << "\n";
+    }
+
+    // NN-Descent against the exact builder on synthetic catalogues. Recall is
+    // measured on up to 500 sampled rows against their exact top-k: an
+    // approximate neighbour counts as a hit when it scores at least the
+    // exact k-th best, so equal-score ties are not held against it. The exact
+    // graph is only built up to exactLimit movies; above that, only the
+    // sampled rows are scored exactly.
+    static void compareNNDescent(std::initializer_list<int> sizes = {10000, 60000, 500000}, int k = 20,
+                                 int exactLimit = 60000) {
+        std::cout << "\n=== NN-DESCENT VS EXACT KNN BUILD ===\n";
+        std::cout << "K: " << k << "\n\n";
+        std::cout << "     Movies    Exact (ms)   NN-Descent (ms)   Iterations   Evaluated   Recall@K\n";
+
+        for (const int n : sizes) {
+            const auto movies = syntheticMovies(n);
+            Graph approx;
+            for (const auto& m : movies) approx.addMovie(m);
+
+            double exactMs = -1.0;
+            if (n <= exactLimit) {
+                Graph exact;
+                for (const auto& m : movies) exact.addMovie(m);
+                auto start = std::chrono::high_resolution_clock::now();
+                buildKNNGraph(exact, k);
+                auto end = std::chrono::high_resolution_clock::now();
+                exactMs = std::chrono::duration<double, std::milli>(end - start).count();
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            const auto stats = buildKNNGraphNNDescent(approx, k);
+            auto end = std::chrono::high_resolution_clock::now();
+            double approxMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+            const auto& features = approx.getFeatures();
+            const GenreIndex index(features);
+            ContentRowScorer scorer(features, index, true);
+            std::vector<std::pair<double,int>> exactRow;
+            std::vector<double> approxSims;
+            std::size_t hits = 0;
+            std::size_t wanted = 0;
+            for (int i = 0; i < n; i += std::max(1, n / 500)) {
+                scorer.topK(i, k, exactRow);
+                if (exactRow.empty()) continue;
+                const double threshold = static_cast<int>(exactRow.size()) == k
+                    ? std::ranges::min(exactRow, {}, &std::pair<double,int>::first).first : 0.0;
+
+                // The row's own list, not its edges: those also hold reverse
+                // links and could lend it more than k candidates.
+                approxSims.clear();
+                for (const auto& [sim, j] : approx.knnList(i)) approxSims.push_back(sim);
+                for (std::size_t r = 0; r < approxSims.size() && r < exactRow.size(); ++r) {
+                    if (approxSims[r] > 0.0 && approxSims[r] >= threshold) ++hits;
+                }
+                wanted += exactRow.size();
+            }
+
+            std::cout << "  " << std::setw(9) << n << std::fixed << std::setprecision(1);
+            if (exactMs >= 0.0) {
+                std::cout << std::setw(14) << exactMs;
+            } else {
+                std::cout << std::setw(14) << "skipped";
+            }
+            std::cout << std::setw(18) << approxMs
+                      << std::setw(13) << stats.iterations
+                      << std::setw(11) << std::setprecision(3)
+                      << (static_cast<double>(stats.similarityEvaluations) / (static_cast<double>(n) * n)) << "n²"
+                      << std::setw(10) << std::setprecision(4)
+                      << (wanted == 0 ? 1.0 : static_cast<double>(hits) / static_cast<double>(wanted)) << "\n";
+        }
+    }
+
+    // Latency of Graph::insertMovieIncremental on a built synthetic catalogue
+    // of n movies, against rebuilding the whole KNN graph once.
+    static void compareIncrementalInsert(const int n = 60000, const int inserts = 200, const int k = 20) {
+        std::cout << "\n=== INCREMENTAL INSERT VS REBUILD ===\n";
+        std::cout << "Movies: " << n << ", inserts: " << inserts << ", K: " << k << "\n\n";
+
+        const auto movies = syntheticMovies(n + inserts);
+        Graph graph;
+        for (int i = 0; i < n; ++i) graph.addMovie(movies[i]);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        buildKNNGraph(graph, k);
+        auto end = std::chrono::high_resolution_clock::now();
+        const double rebuildMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        // The first insert thaws the finalized CSR back into lists and is
+        // reported on its own; the rest are the steady state.
+        start = std::chrono::high_resolution_clock::now();
+        graph.insertMovieIncremental(movies[n], k);
+        end = std::chrono::high_resolution_clock::now();
+        const double firstMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::vector<double> micros;
+        micros.reserve(inserts - 1);
+        for (int i = n + 1; i < n + inserts; ++i) {
+            start = std::chrono::high_resolution_clock::now();
+            graph.insertMovieIncremental(movies[i], k);
+            end = std::chrono::high_resolution_clock::now();
+            micros.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        std::ranges::sort(micros);
+        const double mean = std::accumulate(micros.begin(), micros.end(), 0.0) / static_cast<double>(micros.size());
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Full rebuild:        " << rebuildMs << " ms\n"
+                  << "First insert (thaw): " << firstMs << " ms\n"
+                  << "Insert (mean):       " << mean << " us\n"
+                  << "Insert (median):     " << micros[micros.size() / 2] << " us\n"
+                  << "Insert (max):        " << micros.back() << " us\n";
+    }
+
+    static void compareSimilarityKernels(const Graph& graph) {
+        const auto movies = graph.getMovies();
+        const auto& features = graph.getFeatures();
+        const int n = std::min(graph.size(), 2000);
+
+        std::cout << "\n=== PAIRWISE SIMILARITY KERNEL ===\n";
+        std::cout << "Pairs: " << static_cast<long long>(n) * n << "\n\n";
+
+        double checksumStrings = 0.0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                checksumStrings += similarityScore(movies[i], movies[j]);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double stringsMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        double checksumFeatures = 0.0;
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                checksumFeatures += similarityScore(features[i], features[j]);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double featuresMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        const double pairs = static_cast<double>(n) * n;
+        std::cout << "  Genre string sets: " << std::fixed << std::setprecision(2)
+                  << (stringsMs * 1e6 / pairs) << " ns/pair\n";
+        std::cout << "  Genre bitmasks:    " << std::fixed << std::setprecision(2)
+                  << (featuresMs * 1e6 / pairs) << " ns/pair\n";
+        std::cout << "  Speedup:           " << std::fixed << std::setprecision(1)
+                  << (stringsMs / featuresMs) << "x\n";
+        std::cout << "  Scores match:      " << (checksumStrings == checksumFeatures ? "yes" : "NO") << "\n";
+    }
+
+    static void compareSimilarityIsas(const Graph& graph) {
+        const auto& features = graph.getFeatures();
+        const int n = graph.size();
+        const int sources = std::min(n, 2000);
+        if (n == 0) return;
+
+        std::cout << "\n=== BATCH SIMILARITY KERNEL (one vs all) ===\n";
+        std::cout << "Sources: " << sources << "  Targets: " << n << "\n\n";
+        std::cout << "  ISA        Mpairs/s    Matches scalar\n";
+
+        std::vector<double> reference(n);
+        std::vector<double> scores(n);
+
+        for (const SimdIsa isa : {SimdIsa::Scalar, SimdIsa::AVX2, SimdIsa::AVX512}) {
+            std::cout << "  " << std::left << std::setw(9) << simdIsaName(isa) << std::right;
+            if (!simdIsaSupported(isa)) {
+                std::cout << "  not supported on this CPU\n";
+                continue;
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int s = 0; s < sources; ++s) {
+                scoreBatch(features[s], features, 0, n, scores.data(), isa);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+
+            bool same = true;
+            for (int s = 0; s < sources; s += 97) {
+                scoreBatch(features[s], features, 0, n, reference.data(), SimdIsa::Scalar);
+                scoreBatch(features[s], features, 0, n, scores.data(), isa);
+                same = same && reference == scores;
+            }
+
+            const double pairs = static_cast<double>(sources) * n;
+            std::cout << "  " << std::setw(9) << std::fixed << std::setprecision(1)
+                      << (pairs / seconds / 1e6)
+                      << "    " << (same ? "yes" : "NO") << "\n";
+        }
+    }
+
+    // Parses ratings.csv from `dir` on 1..16 threads. The file is mapped
+    // once and read once beforehand, so every run starts from a warm page
+    // cache.
+    static void compareRatingsIngestion(const std::string& dir) {
+        std::cout << "\n=== MOVIELENS RATINGS INGESTION ===\n";
+
+        const MappedFile moviesFile((std::filesystem::path(dir) / "movies.csv").string());
+        std::vector<int> denseOf;
+        std::size_t denseCount = 0;
+        {
+            CsvCursor csv(skipFirstLine({reinterpret_cast<const char*>(moviesFile.data()), moviesFile.size()}));
+            std::string scratch;
+            while (!csv.done()) {
+                if (int movieId = 0; parseNumber(csv.field(scratch), movieId) && movieId >= 0) {
+                    if (denseOf.size() <= static_cast<std::size_t>(movieId)) denseOf.resize(movieId + 1, -1);
+                    if (denseOf[movieId] < 0) denseOf[movieId] = static_cast<int>(denseCount++);
+                }
+                csv.nextLine();
+            }
+        }
+
+        const MappedFile ratingsFile((std::filesystem::path(dir) / "ratings.csv").string());
+        const double mib = static_cast<double>(ratingsFile.size()) / (1024.0 * 1024.0);
+        std::cout << "File: " << mib << " MiB  Movies: " << denseCount << "\n\n";
+        std::cout << "  Threads     Time (ms)    M rows/s     MiB/s   Speedup   Matches serial\n";
+
+        RatingTotals serial;
+        double serialMs = 0.0;
+        for (const unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+            ThreadPool pool(threads);
+            if (threads == 1) aggregateRatings(ratingsFile, denseOf, denseCount, pool);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            RatingTotals totals = aggregateRatings(ratingsFile, denseOf, denseCount, pool);
+            auto end = std::chrono::high_resolution_clock::now();
+            double duration = std::chrono::duration<double, std::milli>(end - start).count();
+
+            if (threads == 1) {
+                serialMs = duration;
+                serial = std::move(totals);
+            }
+            const bool same = threads == 1 ||
+                (totals.rows == serial.rows && totals.count == serial.count && totals.sum == serial.sum);
+
+            const double rows = static_cast<double>(threads == 1 ? serial.rows : totals.rows);
+            std::cout << "  " << std::setw(7) << threads
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(14) << duration
+                      << std::setw(12) << std::setprecision(2) << (rows / 1e6 / (duration / 1000.0))
+                      << std::setw(10) << std::setprecision(1) << (mib / (duration / 1000.0))
+                      << std::setw(9) << std::setprecision(2) << (serialMs / duration) << "x"
+                      << "   " << (same ? "yes" : "NO") << "\n";
+        }
+    }
+
+    // DOM loader against the streaming SAX loader on the same JSON file.
+    // Peak is the high-water mark of operator new bytes above what was live
+    // before the load started.
+    static void compareGraphLoaders(const std::string& path) {
+        std::cout << "\n=== JSON GRAPH LOADERS ===\n";
+        std::cout << "File: " << path << "\n\n";
+        std::cout << "  Loader     Time (ms)   Peak (MiB)   Graph (MiB)\n";
+
+        Graph reference;
+        for (const bool streaming : {false, true}) {
+            const std::size_t before = liveAllocatedBytes();
+            resetPeakAllocatedBytes();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            Graph g = streaming ? loadGraphFromDisk(path) : loadGraphFromDiskDom(path);
+            auto end = std::chrono::high_resolution_clock::now();
+            double duration = std::chrono::duration<double, std::milli>(end - start).count();
+
+            const double peakMiB = static_cast<double>(peakAllocatedBytes() - before) / (1024.0 * 1024.0);
+            const double graphMiB = static_cast<double>(liveAllocatedBytes() - before) / (1024.0 * 1024.0);
+
+            std::cout << "  " << std::left << std::setw(6) << (streaming ? "SAX" : "DOM") << std::right
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(14) << duration
+                      << std::setw(13) << peakMiB
+                      << std::setw(14) << graphMiB;
+            if (streaming) {
+                std::cout << "   same graph: " << (sameEdges(reference, g) ? "yes" : "NO");
+            } else {
+                reference = std::move(g);
+            }
+            std::cout << "\n";
+        }
+    }
+
+    // DOM writer against the streaming writer, compact and pretty.
+    static void compareGraphWriters(const Graph& graph) {
+        std::cout << "\n=== JSON GRAPH WRITERS ===\n";
+        std::cout << "  Writer            Time (ms)    Size (MiB)     MiB/s   Peak (MiB)\n";
+
+        const std::string path = (std::filesystem::temp_directory_path() / "movie_graph_writer.json").string();
+        for (const int mode : {0, 1, 2}) {
+            const std::size_t before = liveAllocatedBytes();
+            resetPeakAllocatedBytes();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            if (mode == 0) {
+                saveGraphToDiskDom(graph, path);
+            } else {
+                saveGraphToDisk(graph, path, mode == 2);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double duration = std::chrono::duration<double, std::milli>(end - start).count();
+
+            const double peakMiB = static_cast<double>(peakAllocatedBytes() - before) / (1024.0 * 1024.0);
+            const double sizeMiB = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+            const char* name = mode == 0 ? "DOM (indent 2)" : mode == 1 ? "stream compact" : "stream pretty";
+
+            std::cout << "  " << std::left << std::setw(15) << name << std::right
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(12) << duration
+                      << std::setw(14) << sizeMiB
+                      << std::setw(10) << std::setprecision(1) << (sizeMiB / (duration / 1000.0))
+                      << std::setw(13) << std::setprecision(3) << peakMiB << "\n";
+        }
+        std::filesystem::remove(path);
+    }
+
+    // Saves and reloads the graph several times in each format. Edge count,
+    // load time and search time should not grow from one round to the next.
+    static void compareGraphRoundTrips(const Graph& graph, int rounds = 3) {
+        std::cout << "\n=== SAVE/LOAD ROUND TRIPS ===\n";
+        std::cout << "  Format  Round      Edges   Load (ms)   Search (ms)   Same edges\n";
+
+        const auto dir = std::filesystem::temp_directory_path();
+        const std::string jsonPath = (dir / "movie_graph_roundtrip.json").string();
+        const std::string binPath = (dir / "movie_graph_roundtrip.bin").string();
+
+        for (const bool binary : {false, true}) {
+            Graph current = graph;
+            for (int round = 1; round <= rounds; ++round) {
+                auto start = std::chrono::high_resolution_clock::now();
+                Graph loaded;
+                if (binary) {
+                    saveGraphBinary(current, binPath);
+                    start = std::chrono::high_resolution_clock::now();
+                    loaded = loadGraphBinary(binPath);
+                } else {
+                    saveGraphToDisk(current, jsonPath);
+                    start = std::chrono::high_resolution_clock::now();
+                    loaded = loadGraphFromDisk(jsonPath);
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                const double loadMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+                const int sources = std::min(loaded.size(), 100);
+                DijkstraWorkspace ws;
+                start = std::chrono::high_resolution_clock::now();
+                for (int s = 0; s < sources; ++s) dijkstraTopK(s, loaded, loaded.size(), ws);
+                end = std::chrono::high_resolution_clock::now();
+                const double searchMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+                std::cout << "  " << std::left << std::setw(6) << (binary ? "bin" : "json") << std::right
+                          << std::setw(7) << round
+                          << std::setw(11) << loaded.edgeCount()
+                          << std::fixed << std::setprecision(3)
+                          << std::setw(12) << loadMs
+                          << std::setw(14) << (sources > 0 ? searchMs / sources : 0.0)
+                          << "   " << (sameEdges(graph, loaded) ? "yes" : "NO") << "\n";
+                current = std::move(loaded);
+            }
+        }
+
+        std::filesystem::remove(jsonPath);
+        std::filesystem::remove(binPath);
     }
 
 private:
-    static BenchmarkResult benchmarkGraphApproach(Graph& graph, int sourceIndex, int k) {
+    // Catalogue with TMDB-like genre counts, ratings and years, some missing.
+    static std::vector<Movie> syntheticMovies(const int n, const unsigned seed = 42) {
+        static const char* genres[] = {
+            "Action", "Adventure", "Animation", "Comedy", "Crime", "Documentary", "Drama", "Family",
+            "Fantasy", "History", "Horror", "Music", "Mystery", "Romance", "Science Fiction",
+            "TV Movie", "Thriller", "War", "Western"};
+        std::mt19937 rng(seed);
+        std::vector<Movie> movies(n);
+        for (int i = 0; i < n; ++i) {
+            Movie& m = movies[i];
+            m.tmdbId = i + 1;
+            m.name = "Synthetic " + std::to_string(i);
+            for (int c = static_cast<int>(rng() % 4); c > 0; --c) {
+                std::string genre = genres[rng() % std::size(genres)];
+                if (std::ranges::find(m.genres, genre) == m.genres.end()) m.genres.push_back(std::move(genre));
+            }
+            m.rating = rng() % 5 == 0 ? 0.0 : static_cast<double>(rng() % 1000) / 100.0;
+            m.year = rng() % 7 == 0 ? 0 : 1950 + static_cast<int>(rng() % 75);
+        }
+        return movies;
+    }
+
+    template <class Queue>
+    static void benchmarkQueue(const char* name, const Graph& graph, int k,
+                               const std::vector<std::vector<double>>& expected) {
+        const int n = graph.size();
+        const int sources = static_cast<int>(expected.size());
+        BasicDijkstraWorkspace<Queue> ws;
+
+        for (int s = 0; s < sources; ++s) dijkstraTopK(s, graph, k, ws);
+
         auto start = std::chrono::high_resolution_clock::now();
+        for (int s = 0; s < sources; ++s) dijkstraTopK(s, graph, k, ws);
+        auto end = std::chrono::high_resolution_clock::now();
+        double topKMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        bool same = true;
+        start = std::chrono::high_resolution_clock::now();
+        for (int s = 0; s < sources; ++s) {
+            same = same && dijkstraTopK(s, graph, n, ws).distance == expected[s];
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double fullMs = std::chrono::duration<double, std::milli>(end - start).count();
 
-        auto dijkstraResult = dijkstra(sourceIndex, graph.getAdj());
+        std::cout << "  " << std::left << std::setw(13) << name << std::right
+                  << std::fixed << std::setprecision(4)
+                  << std::setw(14) << (topKMs / sources)
+                  << std::setw(16) << (fullMs / sources)
+                  << "   " << (same ? "yes" : "NO") << "\n";
+    }
+
+    static bool sameEdges(const Graph& a, const Graph& b) {
+        if (a.size() != b.size()) return false;
+        for (int u = 0; u < a.size(); ++u) {
+            const auto ea = a.neighbors(u);
+            const auto eb = b.neighbors(u);
+            if (!std::equal(ea.begin(), ea.end(), eb.begin(), eb.end(),
+                    [](const Edge& x, const Edge& y) { return x.to == y.to && x.weight == y.weight; })) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static BenchmarkResult benchmarkGraphApproach(const Graph& graph, int sourceIndex, int k) {
+        const size_t copiesBefore = Graph::deepCopyCount();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        auto dijkstraResult = dijkstra(sourceIndex, graph);
 
         auto recommendations = topKRecommendations(sourceIndex, dijkstraResult, k);
 
         auto end = std::chrono::high_resolution_clock::now();
         double duration = std::chrono::duration<double, std::milli>(end - start).count();
 
-        return {duration, recommendations, 0};
+        const auto settled = static_cast<int>(std::ranges::count_if(dijkstraResult.distance,
+            [](const double d) { return std::isfinite(d); }));
+
+        return {duration, recommendations, 0, Graph::deepCopyCount() - copiesBefore, settled};
     }
 
-    static BenchmarkResult benchmarkHeapApproach(Graph& graph, int sourceIndex, int k) {
+    static BenchmarkResult benchmarkGraphTopKApproach(const Graph& graph, int sourceIndex, int k) {
+        const size_t copiesBefore = Graph::deepCopyCount();
         auto start = std::chrono::high_resolution_clock::now();
 
-        const auto& movies = graph.getMovies();
-        const auto& sourceMovie = movies[sourceIndex];
+        auto topK = dijkstraTopK(sourceIndex, graph, k);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double duration = std::chrono::duration<double, std::milli>(end - start).count();
+
+        return {duration, topK.nodes, 0, Graph::deepCopyCount() - copiesBefore, topK.settled};
+    }
+
+    static BenchmarkResult benchmarkHeapApproach(const Graph& graph, int sourceIndex, int k) {
+        auto start = std::chrono::high_resolution_clock::now();
 
-        auto recommendations = heapTopKRecommendations(sourceMovie, movies, sourceIndex, k);
+        auto recommendations = heapTopKRecommendations(graph.getFeatures(), sourceIndex, k);
 
         auto end = std::chrono::high_resolution_clock::now();
         double duration = std::chrono::duration<double, std::milli>(end - start).count();
@@ -60,11 +925,12 @@ private:
     }
 
     static void printComparison(const BenchmarkResult& graphResult,
+                               const BenchmarkResult& earlyResult,
                                const BenchmarkResult& heapResult,
-                               Graph& graph,
+                               const Graph& graph,
                                int sourceIndex,
                                int k) {
-        const auto& movies = graph.getMovies();
+        const auto movies = graph.getMovies();
         const auto& sourceMovie = movies[sourceIndex];
 
         std::cout << "RESULTS:\n";
@@ -72,11 +938,17 @@ private:
 
         std::cout << "TIME PERFORMANCE:\n";
         std::cout << "  Graph (Dijkstra): " << std::fixed << std::setprecision(3)
-                  << graphResult.time_ms << " ms\n";
+                  << graphResult.time_ms << " ms  (" << graphResult.nodes_settled << " nodes settled)\n";
+        std::cout << "  Graph (top-K):    " << std::fixed << std::setprecision(3)
+                  << earlyResult.time_ms << " ms  (" << earlyResult.nodes_settled << " nodes settled)\n";
         std::cout << "  Heap-based:       " << std::fixed << std::setprecision(3)
                   << heapResult.time_ms << " ms\n";
         std::cout << "  Speedup:          " << std::fixed << std::setprecision(2)
                   << (graphResult.time_ms / heapResult.time_ms) << "x\n";
+        std::cout << "  Top-K vs full:    " << std::fixed << std::setprecision(2)
+                  << (graphResult.time_ms / earlyResult.time_ms) << "x faster\n";
+        std::cout << "  Graph copies on query path: "
+                  << (graphResult.graph_copies + earlyResult.graph_copies) << "\n";
 
         std::cout << "\nTOP-" << k << " RECOMMENDATIONS:\n";
         std::cout << "Graph-based (Dijkstra):\n";
@@ -87,10 +959,12 @@ private:
 
         std::cout << "\nALGORITHM CONSISTENCY:\n";
         checkRecommendationOverlap(graphResult.recommendations, heapResult.recommendations, k);
+        std::cout << "  Top-K Dijkstra vs full Dijkstra:\n";
+        checkRecommendationOverlap(graphResult.recommendations, earlyResult.recommendations, k);
     }
 
     static void printRecommendations(const std::vector<int>& indices,
-                                    const std::vector<Movie>& movies,
+                                    std::span<const Movie> movies,
                                     const Movie& sourceMovie) {
         for (size_t i = 0; i < indices.size(); ++i) {
             int movieIdx = indices[i];
@@ -0,0 +1,278 @@
+#include "mockTmdbServer.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+namespace {
+    using NativeSocket = SOCKET;
+    constexpr auto INVALID_NATIVE_SOCKET = INVALID_SOCKET;
+    constexpr int SHUTDOWN_BOTH = SD_BOTH;
+    constexpr int SEND_FLAGS = 0;
+
+    void closeNative(const NativeSocket s) { closesocket(s); }
+
+    struct WinsockInit {
+        WinsockInit() {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+                throw std::runtime_error("WSAStartup failed");
+            }
+        }
+        ~WinsockInit() { WSACleanup(); }
+    };
+}
+
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    using NativeSocket = int;
+    constexpr NativeSocket INVALID_NATIVE_SOCKET = -1;
+    constexpr int SHUTDOWN_BOTH = SHUT_RDWR;
+#ifdef MSG_NOSIGNAL
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    constexpr int SEND_FLAGS = 0;
+#endif
+
+    void closeNative(const NativeSocket s) { close(s); }
+
+    struct WinsockInit {};
+}
+#endif
+
+namespace {
+    NativeSocket native(const std::uintptr_t s) { return static_cast<NativeSocket>(s); }
+
+    const char* const GENRES[] = {
+        "Action", "Adventure", "Animation", "Comedy", "Crime", "Documentary", "Drama",
+        "Family", "Fantasy", "History", "Horror", "Music", "Mystery", "Romance",
+        "Science Fiction", "TV Movie", "Thriller", "War", "Western"
+    };
+    constexpr int GENRE_COUNT = static_cast<int>(std::size(GENRES));
+
+    // TMDb-style genre ids are not 0..n; offset them so lookups are real.
+    int genreId(const int g) { return 100 + g; }
+
+    nlohmann::json movieSummary(const int id) {
+        nlohmann::json genreIds = nlohmann::json::array();
+        for (int c = 0; c < 1 + id % 3; ++c) genreIds.push_back(genreId((id * 7 + c * 5) % GENRE_COUNT));
+        return {
+            {"id", id},
+            {"title", "Mock Movie " + std::to_string(id)},
+            {"vote_average", 5.0 + static_cast<double>(id % 50) / 10.0},
+            {"vote_count", 1000 + id % 500},
+            {"popularity", 50.0 + id % 100},
+            {"release_date", std::to_string(1950 + id % 75) + "-01-01"},
+            {"genre_ids", genreIds}
+        };
+    }
+
+    nlohmann::json movieDetails(const int id) {
+        nlohmann::json j = movieSummary(id);
+        nlohmann::json genres = nlohmann::json::array();
+        for (const auto& gid : j["genre_ids"]) {
+            genres.push_back({{"id", gid}, {"name", GENRES[gid.get<int>() - 100]}});
+        }
+        j["genres"] = genres;
+        j.erase("genre_ids");
+        return j;
+    }
+
+    std::string queryParam(const std::string& target, const std::string& name) {
+        const auto q = target.find('?');
+        if (q == std::string::npos) return {};
+        std::size_t pos = q + 1;
+        while (pos < target.size()) {
+            const auto amp = std::min(target.find('&', pos), target.size());
+            const auto eq = target.find('=', pos);
+            if (eq < amp && target.compare(pos, eq - pos, name) == 0) {
+                return target.substr(eq + 1, amp - eq - 1);
+            }
+            pos = amp + 1;
+        }
+        return {};
+    }
+
+    // Returns the status code and fills body.
+    int route(const std::string& target, std::string& body) {
+        const std::string path = target.substr(0, target.find('?'));
+        nlohmann::json j;
+
+        if (path == "/3/genre/movie/list") {
+            j["genres"] = nlohmann::json::array();
+            for (int g = 0; g < GENRE_COUNT; ++g) j["genres"].push_back({{"id", genreId(g)}, {"name", GENRES[g]}});
+        } else if (path == "/3/movie/popular") {
+            const std::string pageText = queryParam(target, "page");
+            const int page = pageText.empty() ? 1 : std::max(1, std::atoi(pageText.c_str()));
+            j["page"] = page;
+            j["results"] = nlohmann::json::array();
+            for (int i = 0; i < 20; ++i) j["results"].push_back(movieSummary((page - 1) * 20 + i + 1));
+        } else if (path == "/3/search/movie") {
+            const std::size_t h = std::hash<std::string>{}(queryParam(target, "query"));
+            j["results"] = nlohmann::json::array();
+            for (int i = 0; i < 5; ++i) j["results"].push_back(movieSummary(static_cast<int>((h + i) % 100000) + 1));
+        } else if (path.rfind("/3/movie/", 0) == 0) {
+            const int id = std::atoi(path.c_str() + 9);
+            if (id <= 0) {
+                body = R"({"status_code":34,"status_message":"not found"})";
+                return 404;
+            }
+            j = movieDetails(id);
+        } else {
+            body = R"({"status_code":34,"status_message":"not found"})";
+            return 404;
+        }
+
+        body = j.dump();
+        return 200;
+    }
+
+    bool sendAll(const NativeSocket s, const std::string& data) {
+        std::size_t sent = 0;
+        while (sent < data.size()) {
+            const auto n = send(s, data.data() + sent, static_cast<int>(data.size() - sent), SEND_FLAGS);
+            if (n <= 0) return false;
+            sent += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+}
+
+MockTmdbServer::MockTmdbServer() {
+    [[maybe_unused]] static WinsockInit winsock;
+
+    const NativeSocket s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s == INVALID_NATIVE_SOCKET) {
+        throw std::runtime_error("MockTmdbServer: socket() failed");
+    }
+    const int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&yes), sizeof(yes));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || listen(s, 64) != 0
+        || getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        closeNative(s);
+        throw std::runtime_error("MockTmdbServer: could not listen on 127.0.0.1");
+    }
+
+    listenSocket = static_cast<std::uintptr_t>(s);
+    listenPort = ntohs(addr.sin_port);
+    acceptThread = std::thread(&MockTmdbServer::acceptLoop, this);
+}
+
+MockTmdbServer::~MockTmdbServer() {
+    stop();
+}
+
+std::string MockTmdbServer::baseUrl() const {
+    return "http://127.0.0.1:" + std::to_string(listenPort) + "/3";
+}
+
+void MockTmdbServer::resetCounters() {
+    connectionCount = 0;
+    requestCount = 0;
+}
+
+void MockTmdbServer::acceptLoop() {
+    while (!stopping) {
+        const NativeSocket client = accept(native(listenSocket), nullptr, nullptr);
+        if (client == INVALID_NATIVE_SOCKET) {
+            if (stopping) break;
+            continue;
+        }
+
+        const std::lock_guard lock(connectionsMutex);
+        if (stopping) {
+            closeNative(client);
+            break;
+        }
+        ++connectionCount;
+        openSockets.push_back(static_cast<std::uintptr_t>(client));
+        connectionThreads.emplace_back(&MockTmdbServer::serve, this, static_cast<std::uintptr_t>(client));
+    }
+}
+
+// Reads requests off one connection until the client closes it or asks for
+// Connection: close. Requests are GETs without a body.
+void MockTmdbServer::serve(const std::uintptr_t socket) {
+    const NativeSocket s = native(socket);
+    std::string buffer;
+    char chunk[4096];
+
+    while (!stopping) {
+        std::size_t headerEnd;
+        bool open = true;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            const auto n = recv(s, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                open = false;
+                break;
+            }
+            buffer.append(chunk, static_cast<std::size_t>(n));
+        }
+        if (!open) break;
+
+        std::string head = buffer.substr(0, headerEnd);
+        buffer.erase(0, headerEnd + 4);
+        ++requestCount;
+
+        const auto firstSpace = head.find(' ');
+        const auto secondSpace = head.find(' ', firstSpace + 1);
+        const std::string target = firstSpace == std::string::npos
+            ? std::string{} : head.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+
+        std::ranges::transform(head, head.begin(), [](const unsigned char c) { return std::tolower(c); });
+        const bool closeAfter = head.find("connection: close") != std::string::npos;
+
+        if (const int delay = latencyMs.load(); delay > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        }
+
+        std::string body;
+        const int status = route(target, body);
+        const std::string response =
+            "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK" : " Not Found") + "\r\n"
+            "Content-Type: application/json;charset=utf-8\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: " + (closeAfter ? "close" : "keep-alive") + "\r\n\r\n" + body;
+        if (!sendAll(s, response) || closeAfter) break;
+    }
+
+    const std::lock_guard lock(connectionsMutex);
+    if (const auto it = std::ranges::find(openSockets, socket); it != openSockets.end()) {
+        openSockets.erase(it);
+        closeNative(s);
+    }
+}
+
+void MockTmdbServer::stop() {
+    if (stopping.exchange(true)) return;
+
+    shutdown(native(listenSocket), SHUTDOWN_BOTH);
+    closeNative(native(listenSocket));
+    acceptThread.join();
+
+    std::vector<std::thread> threads;
+    {
+        const std::lock_guard lock(connectionsMutex);
+        for (const std::uintptr_t s : openSockets) shutdown(native(s), SHUTDOWN_BOTH);
+        threads.swap(connectionThreads);
+    }
+    for (auto& t : threads) t.join();
+}
@@ -0,0 +1,57 @@
+#ifndef MOVIERECOMMENDER_MOCKTMDBSERVER_H
+#define MOVIERECOMMENDER_MOCKTMDBSERVER_H
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Local stand-in for the TMDb endpoints TmdbAPI uses (genre list, popular
+// pages, movie details, title search), serving deterministic made-up movies
+// over plain HTTP/1.1 with keep-alive on 127.0.0.1. It counts TCP
+// connections and requests, so a benchmark can see how many connections a
+// run of TmdbAPI calls really opened. One thread per connection.
+class MockTmdbServer {
+public:
+    // Listens on an ephemeral port; throws std::runtime_error on failure.
+    MockTmdbServer();
+    ~MockTmdbServer();
+
+    MockTmdbServer(const MockTmdbServer&) = delete;
+    MockTmdbServer& operator=(const MockTmdbServer&) = delete;
+
+    // Pass as TmdbApiOptions::baseUrl.
+    [[nodiscard]] std::string baseUrl() const;
+    [[nodiscard]] int port() const { return listenPort; }
+
+    [[nodiscard]] std::size_t connections() const { return connectionCount.load(); }
+    [[nodiscard]] std::size_t requests() const { return requestCount.load(); }
+    void resetCounters();
+
+    // Delay added before every response, to stand in for the round trip to
+    // the real API.
+    void setLatency(const std::chrono::milliseconds latency) { latencyMs = static_cast<int>(latency.count()); }
+
+private:
+    void acceptLoop();
+    void serve(std::uintptr_t socket);
+    void stop();
+
+    std::uintptr_t listenSocket;
+    int listenPort = 0;
+    std::atomic<bool> stopping{false};
+    std::atomic<std::size_t> connectionCount{0};
+    std::atomic<std::size_t> requestCount{0};
+    std::atomic<int> latencyMs{0};
+
+    std::mutex connectionsMutex;
+    std::vector<std::uintptr_t> openSockets;
+    std::vector<std::thread> connectionThreads;
+    std::thread acceptThread;
+};
+
+
+#endif //MOVIERECOMMENDER_MOCKTMDBSERVER_H
\ No newline at end of file
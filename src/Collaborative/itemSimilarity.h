@@ -0,0 +1,129 @@
+#ifndef MOVIERECOMMENDER_ITEMSIMILARITY_H
+#define MOVIERECOMMENDER_ITEMSIMILARITY_H
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./ratingMatrix.h"
+#include "../Parallel/threadPool.h"
+
+struct ItemCfOptions {
+    int neighbors = 40;
+    // Bounds the SpGEMM below. Pass it to loadRatingMatrix as well to also
+    // bound loading the matrix, which peaks before this phase starts.
+    std::size_t memoryBudgetBytes = std::size_t{2} << 30;
+    int blockRows = 64;
+};
+
+struct ItemCfStats {
+    std::size_t items = 0;
+    std::size_t itemsWithNeighbors = 0;
+    std::size_t multiplyAdds = 0;
+    unsigned workers = 0;
+    std::size_t matrixBytes = 0;
+    std::size_t scratchBytesPerWorker = 0;
+    double ms = 0.0;
+};
+
+// Best neighbours per item as (similarity, item), strongest first.
+using ItemNeighborRows = std::vector<std::vector<std::pair<double,int>>>;
+
+// Item-item cosine similarity, computed one row of R^T R at a time
+// (Gustavson SpGEMM): for item i, every user u who rated it contributes
+// r_ui * r_uj to each item j that u also rated. The row accumulates into a
+// dense per-worker array with a touched list, is divided by the two norms
+// and cut down to the best `neighbors`.
+//
+// Rows are handed out in blocks of blockRows. The matrix, the output and one
+// accumulator per worker must fit in memoryBudgetBytes; the worker count is
+// lowered until they do, and a budget too small for even one worker throws.
+inline ItemNeighborRows itemCosineTopK(const RatingMatrix& m, const ItemCfOptions& options, ThreadPool& pool,
+                                       ItemCfStats* stats = nullptr) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    const int items = m.itemCount();
+    const int K = options.neighbors;
+
+    const std::size_t matrixBytes = m.bytes();
+    const std::size_t outputBytes = static_cast<std::size_t>(items) * K * sizeof(std::pair<double,int>);
+    const std::size_t scratchBytes = static_cast<std::size_t>(items) * (sizeof(double) + 2 * sizeof(int))
+                                   + static_cast<std::size_t>(items) * sizeof(std::pair<double,int>);
+    if (matrixBytes + outputBytes + scratchBytes > options.memoryBudgetBytes) {
+        throw std::runtime_error("itemCosineTopK: memory budget of " + std::to_string(options.memoryBudgetBytes)
+                                 + " bytes is too small for " + std::to_string(items) + " items");
+    }
+    const auto workers = static_cast<unsigned>(std::clamp<std::size_t>(
+        (options.memoryBudgetBytes - matrixBytes - outputBytes) / scratchBytes, 1, pool.size()));
+
+    ItemNeighborRows rows(items);
+    const int blockRows = std::max(1, options.blockRows);
+    const int blocks = (items + blockRows - 1) / blockRows;
+    std::atomic<int> nextBlock{0};
+    std::atomic<std::size_t> multiplyAdds{0};
+
+    pool.parallelFor(static_cast<int>(workers), [&](int, int) {
+        std::vector<double> acc(items, 0.0);
+        std::vector<int> touched;
+        std::vector<char> seen(items, 0);
+        std::vector<std::pair<double,int>> sims;
+        touched.reserve(items);
+        sims.reserve(items);
+        std::size_t work = 0;
+
+        for (int b = nextBlock++; b < blocks; b = nextBlock++) {
+            const int end = std::min(items, (b + 1) * blockRows);
+            for (int i = b * blockRows; i < end; ++i) {
+                if (m.itemNorm(i) == 0.0) continue;
+
+                for (const auto& [u, rui] : m.itemColumn(i)) {
+                    const auto userItems = m.userRow(u);
+                    work += userItems.size();
+                    for (const auto& [j, ruj] : userItems) {
+                        if (!seen[j]) {
+                            seen[j] = 1;
+                            touched.push_back(j);
+                        }
+                        acc[j] += static_cast<double>(rui) * ruj;
+                    }
+                }
+
+                sims.clear();
+                const double normI = m.itemNorm(i);
+                for (const int j : touched) {
+                    if (j != i && acc[j] > 0.0) sims.emplace_back(acc[j] / (normI * m.itemNorm(j)), j);
+                    acc[j] = 0.0;
+                    seen[j] = 0;
+                }
+                touched.clear();
+
+                auto stronger = [](const auto& a, const auto& b) {
+                    return a.first > b.first || (a.first == b.first && a.second < b.second);
+                };
+                if (static_cast<int>(sims.size()) > K) {
+                    std::ranges::nth_element(sims, sims.begin() + K, stronger);
+                    sims.resize(K);
+                }
+                std::ranges::sort(sims, stronger);
+                rows[i].assign(sims.begin(), sims.end());
+            }
+        }
+        multiplyAdds += work;
+    }, 1);
+
+    if (stats) {
+        stats->items = items;
+        stats->itemsWithNeighbors = std::ranges::count_if(rows, [](const auto& r) { return !r.empty(); });
+        stats->multiplyAdds = multiplyAdds;
+        stats->workers = workers;
+        stats->matrixBytes = matrixBytes;
+        stats->scratchBytesPerWorker = scratchBytes;
+        stats->ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    return rows;
+}
+
+
+#endif //MOVIERECOMMENDER_ITEMSIMILARITY_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef MOVIERECOMMENDER_RATINGMATRIX_H
+#define MOVIERECOMMENDER_RATINGMATRIX_H
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct RatingTriple {
+    std::uint32_t user;
+    std::int32_t item;
+    float value;
+};
+
+// Sparse user x item rating matrix, stored in both orientations as CSR so
+// that item columns and user rows are each one contiguous slice. Items with
+// fewer than minRatingsPerItem ratings are dropped from both.
+class RatingMatrix {
+public:
+    struct Entry {
+        std::int32_t index;
+        float value;
+    };
+
+    RatingMatrix() = default;
+
+    RatingMatrix(const std::vector<std::vector<RatingTriple>>& chunks, const int users, const int items,
+                 const std::size_t minRatingsPerItem)
+        : users(users), items(items) {
+        std::vector<std::uint64_t> perItem(items, 0);
+        for (const auto& chunk : chunks) {
+            for (const RatingTriple& t : chunk) ++perItem[t.item];
+        }
+        std::vector<char> kept(items, 0);
+        for (int i = 0; i < items; ++i) {
+            kept[i] = perItem[i] >= minRatingsPerItem && perItem[i] > 0;
+            keptItems += kept[i];
+        }
+
+        itemOffsets.assign(items + 1, 0);
+        userOffsets.assign(static_cast<std::size_t>(users) + 1, 0);
+        for (const auto& chunk : chunks) {
+            for (const RatingTriple& t : chunk) {
+                if (!kept[t.item]) continue;
+                ++itemOffsets[t.item + 1];
+                ++userOffsets[t.user + 1];
+            }
+        }
+        for (int i = 0; i < items; ++i) itemOffsets[i + 1] += itemOffsets[i];
+        for (int u = 0; u < users; ++u) userOffsets[u + 1] += userOffsets[u];
+
+        byItem.resize(itemOffsets[items]);
+        byUser.resize(userOffsets[users]);
+        std::vector<std::uint64_t> itemFill(itemOffsets.begin(), itemOffsets.end() - 1);
+        std::vector<std::uint64_t> userFill(userOffsets.begin(), userOffsets.end() - 1);
+        for (const auto& chunk : chunks) {
+            for (const RatingTriple& t : chunk) {
+                if (!kept[t.item]) continue;
+                byItem[itemFill[t.item]++] = Entry{static_cast<std::int32_t>(t.user), t.value};
+                byUser[userFill[t.user]++] = Entry{t.item, t.value};
+            }
+        }
+
+        norms.assign(items, 0.0);
+        for (int i = 0; i < items; ++i) {
+            double sq = 0.0;
+            for (const Entry& e : itemColumn(i)) sq += static_cast<double>(e.value) * e.value;
+            norms[i] = std::sqrt(sq);
+        }
+    }
+
+    [[nodiscard]] int userCount() const { return users; }
+    [[nodiscard]] int itemCount() const { return items; }
+    [[nodiscard]] std::size_t keptItemCount() const { return keptItems; }
+    [[nodiscard]] std::size_t ratingCount() const { return byItem.size(); }
+
+    // Users who rated item i, with their ratings.
+    [[nodiscard]] std::span<const Entry> itemColumn(const int i) const {
+        return {byItem.data() + itemOffsets[i], itemOffsets[i + 1] - itemOffsets[i]};
+    }
+
+    // Items user u rated, with the ratings.
+    [[nodiscard]] std::span<const Entry> userRow(const int u) const {
+        return {byUser.data() + userOffsets[u], userOffsets[u + 1] - userOffsets[u]};
+    }
+
+    [[nodiscard]] double itemNorm(const int i) const { return norms[i]; }
+
+    [[nodiscard]] std::size_t bytes() const {
+        return (byItem.size() + byUser.size()) * sizeof(Entry)
+             + (itemOffsets.size() + userOffsets.size()) * sizeof(std::uint64_t)
+             + norms.size() * sizeof(double);
+    }
+
+    // bytes() of a matrix built from `ratings` triples, before any item is
+    // dropped for having too few ratings.
+    static std::size_t bytesFor(const std::size_t ratings, const int users, const int items) {
+        return 2 * ratings * sizeof(Entry)
+             + (static_cast<std::size_t>(items) + users + 2) * sizeof(std::uint64_t)
+             + static_cast<std::size_t>(items) * sizeof(double);
+    }
+
+private:
+    int users = 0;
+    int items = 0;
+    std::size_t keptItems = 0;
+    std::vector<std::uint64_t> itemOffsets;
+    std::vector<Entry> byItem;
+    std::vector<std::uint64_t> userOffsets;
+    std::vector<Entry> byUser;
+    std::vector<double> norms;
+};
+
+
+#endif //MOVIERECOMMENDER_RATINGMATRIX_H
\ No newline at end of file
@@ -5,26 +5,16 @@
 #include <algorithm>
 #include <limits>
 #include "../Graph/graph.h"
+#include "../D_alg/priorityQueues.h"
 
 struct DijkstraResult {
     std::vector<double> distance;
     std::vector<int> parent;
 };
 
-struct NodeState {
-    double dist;
-    int node;
-};
-
-struct CompareState {
-    bool operator()(const NodeState& a, const NodeState& b) const {
-        return a.dist > b.dist;
-    }
-};
-
-inline DijkstraResult dijkstra(const int src, const std::vector<std::vector<Edge>>& adj) {
+inline DijkstraResult dijkstra(const int src, const Graph& g) {
     constexpr double INF = std::numeric_limits<double>::infinity();
-    const int n = static_cast<int>(adj.size());
+    const int n = g.size();
 
     std::vector<double> dist(n, INF);
     std::vector<int> parent(n, -1);
@@ -42,7 +32,7 @@ inline DijkstraResult dijkstra(const int src, const std::vector<std::vector<Edge
 
         if (d > dist[u]) continue;
 
-        for (const Edge& e : adj[u]) {
+        for (const Edge& e : g.neighbors(u)) {
             const int v = e.to;
             if (const double nd = d + e.weight; nd < dist[v]) {
                 dist[v] = nd;
@@ -55,6 +45,105 @@ inline DijkstraResult dijkstra(const int src, const std::vector<std::vector<Edge
     return {dist, parent};
 }
 
+struct DijkstraTopKResult {
+    std::vector<int> nodes;
+    std::vector<double> distance;
+    int settled = 0;
+    int touched = 0;
+};
+
+// Buffers for repeated searches on one graph, one workspace per thread. They
+// grow to the graph size once and are kept between queries; a new query only
+// resets the dist/parent entries the previous one touched, so a warmed-up
+// workspace answers queries without allocating. Queue is one of the queues
+// in priorityQueues.h.
+template <class Queue>
+class BasicDijkstraWorkspace {
+public:
+    void reset(const Graph& g) {
+        constexpr double INF = std::numeric_limits<double>::infinity();
+        const int n = g.size();
+        if (static_cast<int>(dist.size()) < n) {
+            dist.resize(n, INF);
+            parent.resize(n, -1);
+        }
+        for (const int v : touched) {
+            dist[v] = INF;
+            parent[v] = -1;
+        }
+        touched.clear();
+        queue.prepare(g.minEdgeWeight(), g.maxEdgeWeight());
+        result.nodes.clear();
+        result.distance.clear();
+        result.settled = 0;
+        result.touched = 0;
+    }
+
+    void reach(const int v, const double d, const int from) {
+        if (dist[v] == std::numeric_limits<double>::infinity()) {
+            touched.push_back(v);
+        }
+        dist[v] = d;
+        parent[v] = from;
+    }
+
+    std::vector<double> dist;
+    std::vector<int> parent;
+    std::vector<int> touched;
+    Queue queue;
+    DijkstraTopKResult result;
+};
+
+using DijkstraWorkspace = BasicDijkstraWorkspace<BinaryHeapQueue>;
+
+// Dijkstra that stops as soon as k nodes other than src are settled. Nodes
+// are settled in non-decreasing distance, so `nodes` is already the top-k
+// list, nearest first. settled/touched count the nodes popped with a final
+// distance and the nodes that got any tentative distance. The result lives
+// in the workspace and is valid until its next query.
+template <class Queue>
+const DijkstraTopKResult& dijkstraTopK(const int src, const Graph& g, const int k,
+                                       BasicDijkstraWorkspace<Queue>& ws) {
+    ws.reset(g);
+    DijkstraTopKResult& out = ws.result;
+    if (k <= 0) return out;
+
+    ws.reach(src, 0.0, -1);
+    ws.queue.push(0.0, src);
+
+    while (!ws.queue.empty()) {
+        const NodeState cur = ws.queue.pop();
+
+        const int u = cur.node;
+        const double d = cur.dist;
+
+        if (d > ws.dist[u]) continue;
+
+        ++out.settled;
+        if (u != src) {
+            out.nodes.push_back(u);
+            out.distance.push_back(d);
+            if (static_cast<int>(out.nodes.size()) == k) break;
+        }
+
+        for (const Edge& e : g.neighbors(u)) {
+            const int v = e.to;
+            if (const double nd = d + e.weight; nd < ws.dist[v]) {
+                ws.reach(v, nd, u);
+                ws.queue.push(nd, v);
+            }
+        }
+    }
+
+    out.touched = static_cast<int>(ws.touched.size());
+    return out;
+}
+
+inline DijkstraTopKResult dijkstraTopK(const int src, const Graph& g, const int k) {
+    DijkstraWorkspace ws;
+    return dijkstraTopK(src, g, k, ws);
+}
+
 inline std::vector<int> buildPath(const int target, const std::vector<int>& parent) {
     std::vector<int> path;
     for (int curr = target; curr != -1; curr = parent[curr]) {
@@ -0,0 +1,149 @@
+#ifndef MOVIERECOMMENDER_PRIORITYQUEUES_H
+#define MOVIERECOMMENDER_PRIORITYQUEUES_H
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+struct NodeState {
+    double dist;
+    int node;
+};
+
+struct CompareState {
+    bool operator()(const NodeState& a, const NodeState& b) const {
+        return a.dist > b.dist;
+    }
+};
+
+// Min-queues for Dijkstra with lazy deletion. They share one interface:
+// prepare(minWeight, maxWeight) before each search, then push/pop/empty.
+// Storage is kept across searches, so a reused queue does not allocate.
+// The radix heap and the bucket queue rely on Dijkstra's monotone order:
+// nothing is pushed below the last popped distance.
+
+class BinaryHeapQueue {
+public:
+    void prepare(double, double) { heap.clear(); }
+
+    [[nodiscard]] bool empty() const { return heap.empty(); }
+
+    void push(const double d, const int v) {
+        heap.push_back(NodeState{d, v});
+        std::ranges::push_heap(heap, CompareState{});
+    }
+
+    NodeState pop() {
+        std::ranges::pop_heap(heap, CompareState{});
+        const NodeState top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+
+private:
+    std::vector<NodeState> heap;
+};
+
+// Radix heap keyed on the bit pattern of the distance, which orders
+// non-negative doubles exactly like their values. Bucket i > 0 holds keys
+// whose highest bit differing from the last popped key is bit i - 1.
+class RadixHeapQueue {
+public:
+    void prepare(double, double) {
+        for (auto& b : buckets) b.clear();
+        last = 0;
+        count = 0;
+    }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    void push(const double d, const int v) {
+        buckets[bucketOf(std::bit_cast<std::uint64_t>(d))].push_back(NodeState{d, v});
+        ++count;
+    }
+
+    NodeState pop() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) ++i;
+
+            const auto minIt = std::ranges::min_element(buckets[i], {}, &NodeState::dist);
+            last = std::bit_cast<std::uint64_t>(minIt->dist);
+            for (const NodeState& s : buckets[i]) {
+                buckets[bucketOf(std::bit_cast<std::uint64_t>(s.dist))].push_back(s);
+            }
+            buckets[i].clear();
+        }
+
+        const NodeState top = buckets[0].back();
+        buckets[0].pop_back();
+        --count;
+        return top;
+    }
+
+private:
+    std::vector<NodeState> buckets[65];
+    std::uint64_t last = 0;
+    std::size_t count = 0;
+
+    [[nodiscard]] int bucketOf(const std::uint64_t key) const {
+        return key == last ? 0 : 64 - std::countl_zero(key ^ last);
+    }
+};
+
+// Dial-style circular bucket queue over distances quantised to `width`.
+// width never exceeds the smallest edge weight, so the live keys always fit
+// in one lap of the ring. Inside a bucket the smallest distance is popped
+// first, which keeps the settle order exact rather than approximate.
+class BucketQueue {
+public:
+    static constexpr double TARGET_BUCKETS = 1024.0;
+
+    void prepare(const double minWeight, const double maxWeight) {
+        if (!(minWeight > 0.0)) {
+            throw std::runtime_error("BucketQueue needs strictly positive edge weights");
+        }
+        width = maxWeight > 0.0 ? std::min(minWeight, maxWeight / TARGET_BUCKETS) : 1.0;
+        const auto needed = static_cast<std::size_t>(maxWeight / width) + 2;
+        if (buckets.size() < needed) buckets.resize(needed);
+        for (auto& b : buckets) b.clear();
+        ring = needed;
+        current = 0;
+        count = 0;
+    }
+
+    [[nodiscard]] bool empty() const { return count == 0; }
+
+    void push(const double d, const int v) {
+        buckets[slotOf(d) % ring].push_back(NodeState{d, v});
+        ++count;
+    }
+
+    NodeState pop() {
+        while (buckets[current % ring].empty()) ++current;
+
+        auto& bucket = buckets[current % ring];
+        const auto minIt = std::ranges::min_element(bucket, {}, &NodeState::dist);
+        const NodeState top = *minIt;
+        *minIt = bucket.back();
+        bucket.pop_back();
+        --count;
+        return top;
+    }
+
+private:
+    std::vector<std::vector<NodeState>> buckets;
+    double width = 1.0;
+    std::size_t ring = 1;
+    std::size_t current = 0;
+    std::size_t count = 0;
+
+    [[nodiscard]] std::size_t slotOf(const double d) const {
+        return static_cast<std::size_t>(std::floor(d / width));
+    }
+};
+
+
+#endif //MOVIERECOMMENDER_PRIORITYQUEUES_H
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef MOVIERECOMMENDER_RECOMMENDATIONCACHE_H
+#define MOVIERECOMMENDER_RECOMMENDATIONCACHE_H
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include "../D_alg/dAlg.h"
+#include "../Graph/graph.h"
+
+struct RecommendationCacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+
+    [[nodiscard]] double hitRate() const {
+        const std::size_t total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+// LRU cache of dijkstraTopK results keyed by (source, k, graph version).
+// Any change to the graph bumps its version, so stale entries can never be
+// returned; they are dropped as soon as a query sees a newer version.
+// Entry sizes are estimated from their buffers, and the least recently used
+// entries are evicted to stay under maxBytes. Not thread-safe: use one cache
+// per thread, like the workspace.
+class RecommendationCache {
+public:
+    static constexpr std::size_t DEFAULT_MAX_BYTES = std::size_t{64} << 20;
+
+    explicit RecommendationCache(const std::size_t maxBytes = DEFAULT_MAX_BYTES) : maxBytes(maxBytes) {}
+
+    // The top-k for src, from the cache or from a search with `ws`. The
+    // reference is valid until the next call on this cache.
+    template <class Queue>
+    const DijkstraTopKResult& topK(const int src, const Graph& g, const int k, BasicDijkstraWorkspace<Queue>& ws) {
+        if (g.version() != version) {
+            clear();
+            version = g.version();
+        }
+
+        const Key key{src, k, version};
+        if (const auto it = index.find(key); it != index.end()) {
+            ++stats.hits;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->result;
+        }
+
+        ++stats.misses;
+        const DijkstraTopKResult& fresh = dijkstraTopK(src, g, k, ws);
+        Entry entry{key, fresh, 0};
+        entry.result.nodes.shrink_to_fit();
+        entry.result.distance.shrink_to_fit();
+        entry.bytes = entryBytes(entry);
+        if (entry.bytes > maxBytes) {
+            return fresh;
+        }
+
+        stats.bytes += entry.bytes;
+        entries.push_front(std::move(entry));
+        index.emplace(key, entries.begin());
+        evictToFit();
+        stats.entries = entries.size();
+        return entries.front().result;
+    }
+
+    void setMemoryLimit(const std::size_t bytes) {
+        maxBytes = bytes;
+        evictToFit();
+        stats.entries = entries.size();
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+        stats.entries = 0;
+        stats.bytes = 0;
+    }
+
+    [[nodiscard]] std::size_t memoryLimit() const { return maxBytes; }
+    [[nodiscard]] const RecommendationCacheStats& getStats() const { return stats; }
+
+private:
+    struct Key {
+        int src;
+        int k;
+        std::uint64_t version;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::uint64_t h = key.version * 0x9E3779B97F4A7C15ull;
+            h ^= (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.src)) << 32)
+                 | static_cast<std::uint32_t>(key.k);
+            return static_cast<std::size_t>(h ^ (h >> 29));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        DijkstraTopKResult result;
+        std::size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    // List node, hash node and bucket pointers on top of the two buffers.
+    static std::size_t entryBytes(const Entry& e) {
+        return sizeof(Entry) + 4 * sizeof(void*)
+               + sizeof(std::pair<const Key, EntryList::iterator>)
+               + e.result.nodes.capacity() * sizeof(int)
+               + e.result.distance.capacity() * sizeof(double);
+    }
+
+    void evictToFit() {
+        while (stats.bytes > maxBytes && !entries.empty()) {
+            const Entry& last = entries.back();
+            stats.bytes -= last.bytes;
+            index.erase(last.key);
+            entries.pop_back();
+            ++stats.evictions;
+        }
+    }
+
+    std::size_t maxBytes;
+    std::uint64_t version = 0;
+    EntryList entries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+    RecommendationCacheStats stats;
+};
+
+
+#endif //MOVIERECOMMENDER_RECOMMENDATIONCACHE_H
\ No newline at end of file
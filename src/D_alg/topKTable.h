@@ -0,0 +1,212 @@
+#ifndef MOVIERECOMMENDER_TOPKTABLE_H
+#define MOVIERECOMMENDER_TOPKTABLE_H
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../D_alg/dAlg.h"
+#include "../Graph/graph.h"
+#include "../IO/mappedFile.h"
+#include "../Parallel/threadPool.h"
+
+// Precomputed top-K file for a static graph, little-endian:
+//
+//   TopKTableHeader
+//   TopKTableEntry[movieCount * k]     row i = dijkstraTopK(i, k), nearest first
+//
+// Rows with fewer than k reachable movies are padded with node -1. The header
+// carries a fingerprint of the graph (movie ids and edges) so a table is only
+// used with the graph it was computed from.
+
+inline constexpr char TOPK_TABLE_MAGIC[8] = {'M', 'R', 'T', 'O', 'P', 'K', '\0', '\0'};
+inline constexpr std::uint32_t TOPK_TABLE_VERSION = 1;
+inline constexpr std::uint32_t TOPK_TABLE_ENDIAN_TAG = 0x01020304;
+
+struct TopKTableHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint64_t movieCount;
+    std::uint32_t k;
+    std::uint32_t reserved;
+    std::uint64_t graphFingerprint;
+    std::uint64_t entriesOffset;
+    std::uint64_t fileSize;
+    std::uint64_t padding;
+};
+
+struct TopKTableEntry {
+    std::int32_t node;
+    float distance;
+};
+
+static_assert(std::endian::native == std::endian::little, "top-K table files are little-endian");
+static_assert(sizeof(TopKTableHeader) == 64);
+static_assert(sizeof(TopKTableEntry) == 8);
+
+struct TopKTableBuildStats {
+    std::size_t sources = 0;
+    unsigned threads = 0;
+    double ms = 0.0;
+    std::size_t bytes = 0;
+
+    [[nodiscard]] double sourcesPerSecond() const {
+        return ms <= 0.0 ? 0.0 : static_cast<double>(sources) * 1000.0 / ms;
+    }
+};
+
+// FNV-1a over the movie ids and every edge, in row order.
+inline std::uint64_t graphFingerprint(const Graph& g) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    auto mix = [&h](const std::uint64_t v) {
+        for (int b = 0; b < 8; ++b) {
+            h ^= (v >> (8 * b)) & 0xff;
+            h *= 0x100000001b3ull;
+        }
+    };
+
+    const auto movies = g.getMovies();
+    mix(movies.size());
+    for (int u = 0; u < static_cast<int>(movies.size()); ++u) {
+        mix(static_cast<std::uint64_t>(movies[u].tmdbId));
+        const auto nbrs = g.neighbors(u);
+        mix(nbrs.size());
+        for (const Edge& e : nbrs) {
+            mix(static_cast<std::uint64_t>(e.to));
+            mix(std::bit_cast<std::uint64_t>(e.weight));
+        }
+    }
+    return h;
+}
+
+// Runs dijkstraTopK from every source on the pool, one workspace per chunk,
+// and writes the table to `path` (through a temporary file and a rename).
+inline TopKTableBuildStats buildTopKTable(const Graph& g, const int k, ThreadPool& pool, const std::string& path) {
+    if (k <= 0) {
+        throw std::runtime_error("buildTopKTable: k must be positive");
+    }
+    const int n = g.size();
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<TopKTableEntry> entries(static_cast<std::size_t>(n) * k,
+                                        TopKTableEntry{-1, std::numeric_limits<float>::infinity()});
+    pool.parallelFor(n, [&](const int begin, const int end) {
+        DijkstraWorkspace ws;
+        for (int s = begin; s < end; ++s) {
+            const DijkstraTopKResult& res = dijkstraTopK(s, g, k, ws);
+            TopKTableEntry* row = entries.data() + static_cast<std::size_t>(s) * k;
+            for (std::size_t j = 0; j < res.nodes.size(); ++j) {
+                row[j] = TopKTableEntry{res.nodes[j], static_cast<float>(res.distance[j])};
+            }
+        }
+    }, 64);
+
+    TopKTableHeader h{};
+    std::memcpy(h.magic, TOPK_TABLE_MAGIC, sizeof(h.magic));
+    h.version = TOPK_TABLE_VERSION;
+    h.endianTag = TOPK_TABLE_ENDIAN_TAG;
+    h.movieCount = static_cast<std::uint64_t>(n);
+    h.k = static_cast<std::uint32_t>(k);
+    h.graphFingerprint = graphFingerprint(g);
+    h.entriesOffset = sizeof(TopKTableHeader);
+    h.fileSize = h.entriesOffset + entries.size() * sizeof(TopKTableEntry);
+
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("buildTopKTable: failed to open file: " + tmpPath);
+    }
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(TopKTableEntry)));
+    out.close();
+    if (!out) {
+        std::filesystem::remove(tmpPath);
+        throw std::runtime_error("buildTopKTable: failed writing file: " + tmpPath);
+    }
+    std::filesystem::rename(tmpPath, path);
+
+    TopKTableBuildStats stats;
+    stats.sources = static_cast<std::size_t>(n);
+    stats.threads = pool.size();
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    stats.bytes = h.fileSize;
+    return stats;
+}
+
+inline TopKTableBuildStats buildTopKTable(const Graph& g, const int k, const std::string& path,
+                                          const unsigned threads = defaultThreadCount()) {
+    ThreadPool pool(threads);
+    return buildTopKTable(g, k, pool, path);
+}
+
+// A mapped table file. Rows are read in place; opening checks the header
+// and that every entry is a movie of the table or padding, nothing is copied.
+// Check matches() before pairing the table with a graph.
+class TopKTable {
+public:
+    explicit TopKTable(const std::string& path) : file(std::make_shared<const MappedFile>(path)) {
+        if (file->size() < sizeof(TopKTableHeader)) {
+            throw std::runtime_error("Top-K table file is truncated: " + path);
+        }
+        header = reinterpret_cast<const TopKTableHeader*>(file->data());
+        if (std::memcmp(header->magic, TOPK_TABLE_MAGIC, sizeof(header->magic)) != 0) {
+            throw std::runtime_error("Not a top-K table file: " + path);
+        }
+        if (header->endianTag != TOPK_TABLE_ENDIAN_TAG) {
+            throw std::runtime_error("Top-K table file has the wrong byte order: " + path);
+        }
+        if (header->version != TOPK_TABLE_VERSION) {
+            throw std::runtime_error("Unsupported top-K table version " + std::to_string(header->version) + ": " + path);
+        }
+        const std::uint64_t rows = (file->size() - sizeof(TopKTableHeader)) / sizeof(TopKTableEntry);
+        if (header->k == 0 || header->entriesOffset != sizeof(TopKTableHeader)
+            || header->fileSize != file->size() || header->movieCount > rows / header->k) {
+            throw std::runtime_error("Top-K table file is truncated: " + path);
+        }
+        entries = reinterpret_cast<const TopKTableEntry*>(file->data() + header->entriesOffset);
+
+        const auto movies = static_cast<std::int64_t>(header->movieCount);
+        const std::size_t count = static_cast<std::size_t>(header->movieCount) * header->k;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (entries[i].node < -1 || entries[i].node >= movies) {
+                throw std::runtime_error("Top-K table entry out of range: " + path);
+            }
+        }
+    }
+
+    [[nodiscard]] bool matches(const Graph& g) const {
+        return header->movieCount == static_cast<std::uint64_t>(g.size())
+               && header->graphFingerprint == graphFingerprint(g);
+    }
+
+    [[nodiscard]] int k() const { return static_cast<int>(header->k); }
+    [[nodiscard]] std::size_t size() const { return header->movieCount; }
+
+    // Up to k() nearest movies to src, nearest first, in O(k).
+    [[nodiscard]] std::span<const TopKTableEntry> row(const int src) const {
+        if (src < 0 || static_cast<std::uint64_t>(src) >= header->movieCount) {
+            throw std::runtime_error("TopKTable::row: source out of range");
+        }
+        const TopKTableEntry* begin = entries + static_cast<std::size_t>(src) * header->k;
+        std::size_t filled = 0;
+        while (filled < header->k && begin[filled].node >= 0) ++filled;
+        return {begin, filled};
+    }
+
+private:
+    std::shared_ptr<const MappedFile> file;
+    const TopKTableHeader* header = nullptr;
+    const TopKTableEntry* entries = nullptr;
+};
+
+
+#endif //MOVIERECOMMENDER_TOPKTABLE_H
\ No newline at end of file
@@ -0,0 +1,298 @@
+#ifndef MOVIERECOMMENDER_BINARYGRAPH_H
+#define MOVIERECOMMENDER_BINARYGRAPH_H
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./graph.h"
+#include "../IO/mappedFile.h"
+#include "../MoviesUtil/Movie.h"
+
+// Binary graph file, little-endian, every section 8-byte aligned:
+//
+//   BinaryGraphHeader
+//   BinaryMovieRecord[movieCount]
+//   BinaryStringRef[genreCount]        genre names
+//   uint32_t[genreRefCount]            genre ids, sliced by each movie record
+//   char[stringBytes]                  titles and genre names
+//   uint64_t[movieCount + 1]           CSR offsets
+//   Edge[edgeCount]                    {int32 to, 4 bytes padding, double weight}
+//
+// Loading maps the file and hands the offset and edge arrays to the graph in
+// place; only the movie records are copied out.
+
+inline constexpr char BINARY_GRAPH_MAGIC[8] = {'M', 'R', 'G', 'R', 'A', 'P', 'H', '\0'};
+inline constexpr std::uint32_t BINARY_GRAPH_VERSION = 1;
+inline constexpr std::uint32_t BINARY_GRAPH_ENDIAN_TAG = 0x01020304;
+
+struct BinaryGraphHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint64_t movieCount;
+    std::uint64_t edgeCount;
+    std::uint64_t genreCount;
+    std::uint64_t genreRefCount;
+    std::uint64_t stringBytes;
+    std::uint64_t moviesOffset;
+    std::uint64_t genresOffset;
+    std::uint64_t genreRefsOffset;
+    std::uint64_t stringsOffset;
+    std::uint64_t csrOffsetsOffset;
+    std::uint64_t edgesOffset;
+    std::uint64_t fileSize;
+    double minWeight;
+    double maxWeight;
+};
+
+struct BinaryStringRef {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct BinaryMovieRecord {
+    std::int32_t tmdbId;
+    std::int32_t year;
+    double rating;
+    BinaryStringRef name;
+    std::uint32_t genreBegin;
+    std::uint32_t genreCount;
+};
+
+static_assert(std::endian::native == std::endian::little, "binary graph files are little-endian");
+static_assert(sizeof(BinaryGraphHeader) == 128);
+static_assert(sizeof(BinaryMovieRecord) == 32);
+static_assert(sizeof(Edge) == 16 && offsetof(Edge, to) == 0 && offsetof(Edge, weight) == 8);
+
+namespace binary_graph_detail {
+    inline std::uint64_t align8(const std::uint64_t x) { return (x + 7) & ~std::uint64_t{7}; }
+
+    inline void writePadding(std::ofstream& out, const std::uint64_t from, const std::uint64_t to) {
+        static constexpr char zeros[8] = {};
+        out.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+
+    template<class T>
+    void writeArray(std::ofstream& out, const T* data, const std::size_t count) {
+        out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+    }
+
+    template<class T>
+    const T* section(const MappedFile& file, const std::uint64_t offset, const std::uint64_t count,
+                     const char* what) {
+        if (offset % alignof(T) != 0 || offset > file.size() || count > (file.size() - offset) / sizeof(T)) {
+            throw std::runtime_error(std::string("Binary graph section out of bounds: ") + what);
+        }
+        return reinterpret_cast<const T*>(file.data() + offset);
+    }
+}
+
+// Requires a finalized graph. The file is written next to `path` and renamed
+// over it, so a graph still mapped from the old file stays valid.
+inline void saveGraphBinary(const Graph& g, const std::string& path) {
+    using namespace binary_graph_detail;
+    if (!g.isFinalized()) {
+        throw std::runtime_error("saveGraphBinary: graph must be finalized");
+    }
+
+    const auto movies = g.getMovies();
+    const auto& genreNames = g.getGenres().getNames();
+    std::unordered_map<std::string, std::uint32_t> genreIds;
+    for (std::size_t i = 0; i < genreNames.size(); ++i) {
+        genreIds.emplace(genreNames[i], static_cast<std::uint32_t>(i));
+    }
+
+    std::string strings;
+    auto addString = [&](const std::string& s) {
+        const BinaryStringRef ref{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(s.size())};
+        strings += s;
+        return ref;
+    };
+
+    std::vector<BinaryStringRef> genres;
+    genres.reserve(genreNames.size());
+    for (const auto& name : genreNames) genres.push_back(addString(name));
+
+    std::vector<BinaryMovieRecord> records;
+    std::vector<std::uint32_t> genreRefs;
+    records.reserve(movies.size());
+    for (const Movie& m : movies) {
+        BinaryMovieRecord r{};
+        r.tmdbId = m.tmdbId;
+        r.year = m.year;
+        r.rating = m.rating;
+        r.name = addString(m.name);
+        r.genreBegin = static_cast<std::uint32_t>(genreRefs.size());
+        r.genreCount = static_cast<std::uint32_t>(m.genres.size());
+        for (const auto& genre : m.genres) genreRefs.push_back(genreIds.at(genre));
+        records.push_back(r);
+    }
+
+    const auto& csr = g.getCsr();
+    const auto offsets = csr.offsets();
+    const auto edges = csr.edges();
+
+    BinaryGraphHeader h{};
+    std::memcpy(h.magic, BINARY_GRAPH_MAGIC, sizeof(h.magic));
+    h.version = BINARY_GRAPH_VERSION;
+    h.endianTag = BINARY_GRAPH_ENDIAN_TAG;
+    h.movieCount = records.size();
+    h.edgeCount = edges.size();
+    h.genreCount = genres.size();
+    h.genreRefCount = genreRefs.size();
+    h.stringBytes = strings.size();
+    h.moviesOffset = align8(sizeof(BinaryGraphHeader));
+    h.genresOffset = align8(h.moviesOffset + records.size() * sizeof(BinaryMovieRecord));
+    h.genreRefsOffset = align8(h.genresOffset + genres.size() * sizeof(BinaryStringRef));
+    h.stringsOffset = align8(h.genreRefsOffset + genreRefs.size() * sizeof(std::uint32_t));
+    h.csrOffsetsOffset = align8(h.stringsOffset + strings.size());
+    h.edgesOffset = align8(h.csrOffsetsOffset + offsets.size() * sizeof(std::uint64_t));
+    h.fileSize = h.edgesOffset + edges.size() * sizeof(Edge);
+    h.minWeight = g.minEdgeWeight();
+    h.maxWeight = g.maxEdgeWeight();
+
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("saveGraphBinary: failed to open file: " + tmpPath);
+    }
+
+    writeArray(out, &h, 1);
+    writePadding(out, sizeof(h), h.moviesOffset);
+    writeArray(out, records.data(), records.size());
+    writePadding(out, h.moviesOffset + records.size() * sizeof(BinaryMovieRecord), h.genresOffset);
+    writeArray(out, genres.data(), genres.size());
+    writePadding(out, h.genresOffset + genres.size() * sizeof(BinaryStringRef), h.genreRefsOffset);
+    writeArray(out, genreRefs.data(), genreRefs.size());
+    writePadding(out, h.genreRefsOffset + genreRefs.size() * sizeof(std::uint32_t), h.stringsOffset);
+    writeArray(out, strings.data(), strings.size());
+    writePadding(out, h.stringsOffset + strings.size(), h.csrOffsetsOffset);
+    writeArray(out, offsets.data(), offsets.size());
+    writePadding(out, h.csrOffsetsOffset + offsets.size() * sizeof(std::uint64_t), h.edgesOffset);
+
+    // Edge records are written field by field so the padding is zeroed.
+    struct EdgeRecord { std::int32_t to; std::uint32_t pad; double weight; };
+    std::vector<EdgeRecord> block;
+    block.reserve(4096);
+    for (std::size_t i = 0; i < edges.size(); i += 4096) {
+        block.clear();
+        for (std::size_t j = i; j < std::min(edges.size(), i + 4096); ++j) {
+            block.push_back(EdgeRecord{edges[j].to, 0, edges[j].weight});
+        }
+        writeArray(out, block.data(), block.size());
+    }
+
+    out.close();
+    if (!out) {
+        std::filesystem::remove(tmpPath);
+        throw std::runtime_error("saveGraphBinary: failed writing file: " + tmpPath);
+    }
+    std::filesystem::rename(tmpPath, path);
+}
+
+inline Graph loadGraphBinary(const std::string& path) {
+    using namespace binary_graph_detail;
+    auto file = std::make_shared<const MappedFile>(path);
+
+    const auto* h = section<BinaryGraphHeader>(*file, 0, 1, "header");
+    if (std::memcmp(h->magic, BINARY_GRAPH_MAGIC, sizeof(h->magic)) != 0) {
+        throw std::runtime_error("Not a binary graph file: " + path);
+    }
+    if (h->endianTag != BINARY_GRAPH_ENDIAN_TAG) {
+        throw std::runtime_error("Binary graph file has the wrong byte order: " + path);
+    }
+    if (h->version != BINARY_GRAPH_VERSION) {
+        throw std::runtime_error("Unsupported binary graph version " + std::to_string(h->version) + ": " + path);
+    }
+    if (h->fileSize != file->size()) {
+        throw std::runtime_error("Binary graph file is truncated: " + path);
+    }
+
+    const std::size_t n = h->movieCount;
+    const auto* records = section<BinaryMovieRecord>(*file, h->moviesOffset, n, "movies");
+    const auto* genres = section<BinaryStringRef>(*file, h->genresOffset, h->genreCount, "genres");
+    const auto* genreRefs = section<std::uint32_t>(*file, h->genreRefsOffset, h->genreRefCount, "genre refs");
+    const auto* strings = section<char>(*file, h->stringsOffset, h->stringBytes, "strings");
+    const auto* offsets = section<std::uint64_t>(*file, h->csrOffsetsOffset, n + 1, "offsets");
+    const auto* edges = section<Edge>(*file, h->edgesOffset, h->edgeCount, "edges");
+
+    auto text = [&](const BinaryStringRef ref) {
+        if (ref.offset > h->stringBytes || ref.length > h->stringBytes - ref.offset) {
+            throw std::runtime_error("Binary graph string out of bounds: " + path);
+        }
+        return std::string(strings + ref.offset, ref.length);
+    };
+
+    std::vector<std::string> genreNames;
+    genreNames.reserve(h->genreCount);
+    for (std::size_t i = 0; i < h->genreCount; ++i) genreNames.push_back(text(genres[i]));
+
+    Graph g;
+    for (std::size_t i = 0; i < n; ++i) {
+        const BinaryMovieRecord& r = records[i];
+        if (r.genreBegin > h->genreRefCount || r.genreCount > h->genreRefCount - r.genreBegin) {
+            throw std::runtime_error("Binary graph genre list out of bounds at movie " + std::to_string(i));
+        }
+
+        Movie m;
+        m.tmdbId = r.tmdbId;
+        m.year = r.year;
+        m.rating = r.rating;
+        m.name = text(r.name);
+        m.genres.reserve(r.genreCount);
+        for (std::uint32_t k = 0; k < r.genreCount; ++k) {
+            const std::uint32_t id = genreRefs[r.genreBegin + k];
+            if (id >= genreNames.size()) {
+                throw std::runtime_error("Invalid genre id at movie " + std::to_string(i));
+            }
+            m.genres.push_back(genreNames[id]);
+        }
+        if (g.addMovie(m) != static_cast<int>(i)) {
+            throw std::runtime_error("Invalid or repeated tmdbId at movie " + std::to_string(i) + ": " + path);
+        }
+    }
+    if (static_cast<std::size_t>(g.size()) != n) {
+        throw std::runtime_error("Binary graph movie count does not match its records: " + path);
+    }
+
+    if (offsets[0] != 0 || offsets[n] != h->edgeCount) {
+        throw std::runtime_error("Binary graph offsets do not match edge count: " + path);
+    }
+    for (std::size_t u = 0; u < n; ++u) {
+        if (offsets[u] > offsets[u + 1]) {
+            throw std::runtime_error("Binary graph offsets decrease at row " + std::to_string(u));
+        }
+    }
+    // The weight bounds are recomputed rather than taken from the header:
+    // the bucket queue divides by them.
+    double minWeight = std::numeric_limits<double>::infinity();
+    double maxWeight = 0.0;
+    for (std::size_t e = 0; e < h->edgeCount; ++e) {
+        if (edges[e].to < 0 || static_cast<std::size_t>(edges[e].to) >= n) {
+            throw std::runtime_error("Invalid edge target in binary graph: " + path);
+        }
+        const double w = edges[e].weight;
+        if (!std::isfinite(w) || !(w > 0.0)) {
+            throw std::runtime_error("Invalid edge weight in binary graph: " + path);
+        }
+        minWeight = std::min(minWeight, w);
+        maxWeight = std::max(maxWeight, w);
+    }
+
+    CsrAdjacency csr({offsets, n + 1}, {edges, h->edgeCount}, file);
+    g.adoptCsr(std::move(csr), minWeight, maxWeight);
+    return g;
+}
+
+
+#endif //MOVIERECOMMENDER_BINARYGRAPH_H
\ No newline at end of file
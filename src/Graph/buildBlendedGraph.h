@@ -0,0 +1,84 @@
+#ifndef MOVIERECOMMENDER_BUILDBLENDEDGRAPH_H
+#define MOVIERECOMMENDER_BUILDBLENDEDGRAPH_H
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+#include "./Graph/graph.h"
+#include "./Graph/buildKNNGraph.h"
+#include "./Collaborative/itemSimilarity.h"
+#include "./MoviesUtil/similarityScore.h"
+#include "./Parallel/threadPool.h"
+
+struct BlendedBuildStats {
+    std::size_t collaborativeRows = 0;
+    std::size_t contentRows = 0;
+};
+
+// Builds K-nearest-neighbour edges from collaborative neighbours, indexed by
+// graph movie. A candidate's similarity is
+//   cfWeight * cosine + (1 - cfWeight) * similarityScore(content),
+// so cfWeight = 1 uses the rating co-occurrence alone. Movies without
+// collaborative neighbours (too few ratings) fall back to the content top-K.
+inline BlendedBuildStats buildBlendedGraph(Graph& g, const ItemNeighborRows& cf, const int K, const double cfWeight,
+                                           ThreadPool& pool) {
+    const auto& features = g.getFeatures();
+    const int n = static_cast<int>(features.size());
+    if (n == 0) return {};
+
+    const GenreIndex index(features);
+    std::vector<std::vector<std::pair<double,int>>> rows(n);
+    std::atomic<std::size_t> collaborativeRows{0};
+
+    pool.parallelFor(n, [&](const int begin, const int end) {
+        ContentRowScorer scorer(features, index, true);
+        std::vector<std::pair<double,int>> sims;
+        std::size_t fromCf = 0;
+
+        for (int i = begin; i < end; ++i) {
+            if (static_cast<std::size_t>(i) >= cf.size() || cf[i].empty()) {
+                scorer.topK(i, K, rows[i]);
+                continue;
+            }
+
+            sims.clear();
+            const MovieFeatures source = features[i];
+            for (const auto& [cosine, j] : cf[i]) {
+                const double content = cfWeight < 1.0 ? similarityScore(source, features[j]) : 0.0;
+                if (const double sim = cfWeight * cosine + (1.0 - cfWeight) * content; sim > 0.0)
+                    sims.emplace_back(sim, j);
+            }
+
+            auto stronger = [](const auto& a, const auto& b) {
+                return a.first > b.first || (a.first == b.first && a.second < b.second);
+            };
+            if (static_cast<int>(sims.size()) > K) {
+                std::ranges::nth_element(sims, sims.begin() + K, stronger);
+                sims.resize(K);
+            }
+            std::ranges::sort(sims, stronger);
+            rows[i].assign(sims.begin(), sims.end());
+            ++fromCf;
+        }
+        collaborativeRows += fromCf;
+    }, 16);
+
+    for (int i = 0; i < n; ++i) {
+        for (auto& [sim, j] : rows[i]) {
+            g.addEdge(i, j, weightFromSimilarity(sim));
+        }
+    }
+
+    g.finalize();
+    // The blended scores, so an incremental insert compares against what
+    // actually chose these rows.
+    g.setKnnLists(std::move(rows), K);
+
+    BlendedBuildStats stats;
+    stats.collaborativeRows = collaborativeRows;
+    stats.contentRows = n - stats.collaborativeRows;
+    return stats;
+}
+
+
+#endif //MOVIERECOMMENDER_BUILDBLENDEDGRAPH_H
\ No newline at end of file
@@ -5,12 +5,12 @@
 
 
 inline void buildEdges(Graph& graph) {
-    const auto& movies = graph.getMovies();
-    const int n = static_cast<int>(movies.size());
+    const auto& features = graph.getFeatures();
+    const int n = static_cast<int>(features.size());
 
     for (int i = 0; i < n; i++) {
         for (int j = i + 1; j < n; j++) {
-            const double similarity = similarityScore(movies[i], movies[j]);
+            const double similarity = similarityScore(features[i], features[j]);
             if (similarity <= 0.0) {
                 continue;
             }
@@ -18,10 +18,11 @@ inline void buildEdges(Graph& graph) {
             graph.addEdge(i, j, weight);
         }
     }
+    graph.finalize();
+
     std::cout << "Edges:\n";
-    const auto& adj = graph.getAdj();
-    for (int u = 0; u < static_cast<int>(adj.size()); ++u) {
-        for (auto& e : adj[u]) {
+    for (int u = 0; u < graph.size(); ++u) {
+        for (auto& e : graph.neighbors(u)) {
             std::cout << "  " << u << " -> " << e.to
                       << "  w=" << e.weight << "\n";
         }
@@ -1,44 +1,13 @@
 #ifndef MOVIERECOMMENDER_BUILDGLOBALGRAPH_H
 #define MOVIERECOMMENDER_BUILDGLOBALGRAPH_H
 #include "graph.h"
-#include "../MoviesUtil/similarityScore.h"
-#include <algorithm>
+#include "buildKNNGraph.h"
 
 inline void buildGlobalGraph(Graph& g, const std::vector<Movie>& all) {
     for (const auto& m : all)
         g.addMovie(m);
 
-    const auto& movies = g.getMovies();
-    const int n = static_cast<int>(movies.size());
-
-    std::vector<std::pair<double,int>> sims;
-    sims.reserve(n);
-
-    for (int i = 0; i < n; ++i) {
-        sims.clear();
-        for (int j = 0; j < n; ++j) {
-            if (i == j) continue;
-            if (double sim = similarityScore(movies[i], movies[j]); sim > 0.0) sims.push_back({sim, j});
-        }
-
-        if (sims.empty()) continue;
-
-        if (int K = 40; static_cast<int>(sims.size()) > K) {
-            std::nth_element(sims.begin(), sims.begin() + K, sims.end(),
-                [](const auto& a, const auto& b){ return a.first > b.first; }
-            );
-            sims.resize(K);
-        } else {
-            std::sort(sims.begin(), sims.end(),
-                [](const auto& a, const auto& b){ return a.first > b.first; }
-            );
-        }
-
-        for (auto& [sim, j] : sims) {
-            const double w = weightFromSimilarity(sim);
-            g.addEdge(i, j, w);
-        }
-    }
+    buildKNNGraph(g, 40);
 }
 
 
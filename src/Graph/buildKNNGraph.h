@@ -1,26 +1,72 @@
 #ifndef MOVIERECOMMENDER_BUILDKNNGRAPH_H
 #define MOVIERECOMMENDER_BUILDKNNGRAPH_H
 #include "./Graph/graph.h"
+#include "./Graph/genreIndex.h"
 #include "./MoviesUtil/similarityScore.h"
+#include "./MoviesUtil/similarityBatch.h"
+#include "./Parallel/threadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 
-inline void buildKNNGraph(Graph& g, const int K) {
-    const auto& movies = g.getMovies();
-    const int n = static_cast<int>(movies.size());
-    if (n == 0) return;
+struct KnnBuildStats {
+    std::size_t rows = 0;
+    std::size_t pairsScored = 0;
+    std::size_t pairsPruned = 0;
+    std::size_t minCandidates = 0;
+    std::size_t maxCandidates = 0;
 
-    std::vector<std::pair<double,int>> sims;
-    sims.reserve(n);
+    [[nodiscard]] double prunedPerRow() const {
+        return rows == 0 ? 0.0 : static_cast<double>(pairsPruned) / static_cast<double>(rows);
+    }
+};
 
-    for (int i = 0; i < n; ++i) {
+// Per-thread scratch for scoring one movie against the catalogue by content.
+// With pruneByGenre, a row only scores the candidates from the genre index,
+// gathered into a small column table for the batch kernel. Rows whose
+// candidate lists would cover a large part of the catalogue skip the gather
+// and scan everything. Either way the kept pairs, their order and their
+// scores are unchanged.
+class ContentRowScorer {
+public:
+    ContentRowScorer(const FeatureTable& features, const GenreIndex& index, const bool pruneByGenre)
+        : features(features), index(index), pruneByGenre(pruneByGenre), scores(features.size()) {
+        sims.reserve(features.size());
+    }
+
+    // Fills `row` with movie i's best K (similarity, j) pairs with positive
+    // similarity. Returns the number of pairs scored.
+    std::size_t topK(const int i, const int K, std::vector<std::pair<double,int>>& row) {
+        const int n = static_cast<int>(features.size());
+        std::size_t scored;
         sims.clear();
+        const MovieFeatures source = features[i];
+
+        if (const std::uint64_t mask = source.genreMask;
+            pruneByGenre && mask != 0 && index.candidateBound(mask) * 2 < static_cast<std::size_t>(n)) {
+            index.candidates(mask, i, candidates, scratch);
+            gathered.clear();
+            for (const int j : candidates) gathered.push_back(features[j]);
+            scoreBatch(source, gathered, 0, candidates.size(), scores.data());
 
-        for (int j = 0; j < n; ++j) {
-            if (i == j) continue;
-            if (double sim = similarityScore(movies[i], movies[j]); sim > 0.0)
-                sims.emplace_back(sim, j);
+            for (std::size_t c = 0; c < candidates.size(); ++c) {
+                if (double sim = scores[c]; sim > 0.0)
+                    sims.emplace_back(sim, candidates[c]);
+            }
+            scored = candidates.size();
+        } else {
+            scoreBatch(source, features, 0, n, scores.data());
+            for (int j = 0; j < n; ++j) {
+                if (i == j) continue;
+                if (double sim = scores[j]; sim > 0.0)
+                    sims.emplace_back(sim, j);
+            }
+            scored = n - 1;
         }
 
-        if (sims.empty()) continue;
+        row.clear();
+        if (sims.empty()) return scored;
 
         if (static_cast<int>(sims.size()) > K) {
             std::ranges::nth_element(sims, sims.begin() + K,
@@ -33,11 +79,77 @@ inline void buildKNNGraph(Graph& g, const int K) {
             );
         }
 
-        for (auto& [sim, j] : sims) {
+        row.assign(sims.begin(), sims.end());
+        return scored;
+    }
+
+private:
+    const FeatureTable& features;
+    const GenreIndex& index;
+    bool pruneByGenre;
+    std::vector<std::pair<double,int>> sims;
+    std::vector<double> scores;
+    std::vector<int> candidates;
+    FeatureTable gathered;
+    GenreIndex::Scratch scratch;
+};
+
+// Rows are scored in parallel, each worker writing only its own rows' top-K
+// lists. Edges are then added row by row in index order, so the graph is
+// identical to a single-threaded build.
+inline KnnBuildStats buildKNNGraph(Graph& g, const int K, ThreadPool& pool, const bool pruneByGenre = true) {
+    const auto& features = g.getFeatures();
+    const int n = static_cast<int>(features.size());
+    if (n == 0) return {};
+
+    const GenreIndex index(features);
+    std::vector<std::vector<std::pair<double,int>>> rows(n);
+
+    std::atomic<std::size_t> pairsScored{0};
+    std::atomic<std::size_t> minCandidates{std::numeric_limits<std::size_t>::max()};
+    std::atomic<std::size_t> maxCandidates{0};
+
+    pool.parallelFor(n, [&](const int begin, const int end) {
+        ContentRowScorer scorer(features, index, pruneByGenre);
+        std::size_t scored = 0;
+        std::size_t chunkMin = std::numeric_limits<std::size_t>::max();
+        std::size_t chunkMax = 0;
+
+        for (int i = begin; i < end; ++i) {
+            const std::size_t rowScored = scorer.topK(i, K, rows[i]);
+            scored += rowScored;
+            chunkMin = std::min(chunkMin, rowScored);
+            chunkMax = std::max(chunkMax, rowScored);
+        }
+
+        pairsScored += scored;
+        for (std::size_t cur = minCandidates; chunkMin < cur && !minCandidates.compare_exchange_weak(cur, chunkMin);) {}
+        for (std::size_t cur = maxCandidates; chunkMax > cur && !maxCandidates.compare_exchange_weak(cur, chunkMax);) {}
+    }, 16);
+
+    for (int i = 0; i < n; ++i) {
+        for (auto& [sim, j] : rows[i]) {
             const double w = weightFromSimilarity(sim);
             g.addEdge(i, j, w);
         }
     }
+
+    g.finalize();
+    g.setKnnLists(std::move(rows), K);
+
+    KnnBuildStats stats;
+    stats.rows = n;
+    stats.pairsScored = pairsScored;
+    stats.pairsPruned = static_cast<std::size_t>(n) * (n - 1) - stats.pairsScored;
+    stats.minCandidates = minCandidates;
+    stats.maxCandidates = maxCandidates;
+    return stats;
+}
+
+inline KnnBuildStats buildKNNGraph(Graph& g, const int K, const unsigned threads = defaultThreadCount(),
+                                   const bool pruneByGenre = true) {
+    ThreadPool pool(threads);
+    return buildKNNGraph(g, K, pool, pruneByGenre);
 }
 
 
@@ -0,0 +1,268 @@
+#ifndef MOVIERECOMMENDER_BUILDNNDESCENTGRAPH_H
+#define MOVIERECOMMENDER_BUILDNNDESCENTGRAPH_H
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "./Graph/graph.h"
+#include "./MoviesUtil/similarityScore.h"
+#include "./Parallel/threadPool.h"
+
+struct NnDescentOptions {
+    int maxIterations = 12;
+    double sampleRate = 1.0;
+    // Stop once an iteration improves fewer than earlyStop * n * K entries.
+    double earlyStop = 0.001;
+    std::uint64_t seed = 42;
+    int blockRows = 16384;
+};
+
+struct NnDescentStats {
+    int iterations = 0;
+    std::size_t similarityEvaluations = 0;
+    std::vector<std::size_t> updatesPerIteration;
+};
+
+namespace nn_descent_detail {
+    struct Neighbor {
+        double sim;
+        int id;
+        bool isNew;
+    };
+
+    struct Update {
+        int target;
+        int id;
+        double sim;
+    };
+
+    inline std::uint64_t splitmix(std::uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // Small deterministic generator, seeded per node and iteration so the
+    // result does not depend on how rows are spread over threads.
+    struct Rng {
+        std::uint64_t state;
+        std::uint64_t next() { return state = splitmix(state); }
+        int below(const int n) { return static_cast<int>(next() % static_cast<std::uint64_t>(n)); }
+    };
+
+    // Fixed-size list of K entries, best first; empty slots have id -1.
+    class NeighborLists {
+    public:
+        NeighborLists(const int n, const int K)
+            : K(K), entries(static_cast<std::size_t>(n) * K, Neighbor{-std::numeric_limits<double>::infinity(), -1, false}) {}
+
+        [[nodiscard]] Neighbor* row(const int u) { return entries.data() + static_cast<std::size_t>(u) * K; }
+        [[nodiscard]] const Neighbor* row(const int u) const { return entries.data() + static_cast<std::size_t>(u) * K; }
+        [[nodiscard]] double worst(const int u) const { return row(u)[K - 1].sim; }
+
+        bool insert(const int u, const int v, const double sim) {
+            Neighbor* r = row(u);
+            if (sim <= r[K - 1].sim) return false;
+            for (int k = 0; k < K && r[k].id >= 0; ++k) {
+                if (r[k].id == v) return false;
+            }
+            int pos = K - 1;
+            while (pos > 0 && r[pos - 1].sim < sim) {
+                r[pos] = r[pos - 1];
+                --pos;
+            }
+            r[pos] = Neighbor{sim, v, true};
+            return true;
+        }
+
+    private:
+        int K;
+        std::vector<Neighbor> entries;
+    };
+
+    inline void sampleInto(std::vector<int>& list, const std::size_t limit, Rng& rng) {
+        for (std::size_t k = 0; k < list.size() && k < limit; ++k) {
+            std::swap(list[k], list[k + rng.below(static_cast<int>(list.size() - k))]);
+        }
+        if (list.size() > limit) list.resize(limit);
+    }
+}
+
+// Approximate KNN graph by NN-Descent (Dong et al.): start from random
+// neighbour lists and repeatedly compare each node's neighbours with each
+// other (the local join), keeping any pair that beats a current entry.
+// New and old entries are tracked so a pair is only compared once, and both
+// forward and reverse neighbours are sampled at sampleRate * K.
+//
+// The local join runs in parallel over blocks of nodes against a read-only
+// snapshot of the lists, filing each proposed update under the worker that
+// owns its target's range; each worker then applies only its own updates.
+// Update order is fixed, so the output does not depend on the thread count.
+// Edges are added like buildKNNGraph: each row's positive-similarity
+// entries, best first, which are also kept as the graph's KNN lists.
+inline NnDescentStats buildKNNGraphNNDescent(Graph& g, const int K, ThreadPool& pool,
+                                              const NnDescentOptions& options = {}) {
+    using namespace nn_descent_detail;
+    const auto& features = g.getFeatures();
+    const int n = static_cast<int>(features.size());
+    NnDescentStats stats;
+    if (n < 2 || K <= 0) {
+        g.finalize();
+        return stats;
+    }
+
+    const int k = std::min(K, n - 1);
+    const auto sampleSize = static_cast<std::size_t>(std::max(1.0, options.sampleRate * k));
+    NeighborLists lists(n, k);
+    std::atomic<std::size_t> evaluations{0};
+
+    pool.parallelFor(n, [&](const int begin, const int end) {
+        std::size_t evals = 0;
+        for (int u = begin; u < end; ++u) {
+            Rng rng{splitmix(options.seed ^ static_cast<std::uint64_t>(u))};
+            const MovieFeatures fu = features[u];
+            for (int filled = 0; filled < k;) {
+                const int v = rng.below(n);
+                if (v == u) continue;
+                const Neighbor* r = lists.row(u);
+                if (std::any_of(r, r + filled, [&](const Neighbor& x) { return x.id == v; })) continue;
+                lists.insert(u, v, similarityScore(fu, features[v]));
+                ++evals;
+                ++filled;
+            }
+        }
+        evaluations += evals;
+    }, 256);
+
+    std::vector<std::vector<int>> newList(n), oldList(n), reverseNew(n), reverseOld(n);
+    const int workers = static_cast<int>(pool.size());
+    std::vector<int> ownerBegin(workers + 1);
+    for (int w = 0; w <= workers; ++w) {
+        ownerBegin[w] = static_cast<int>(static_cast<long long>(n) * w / workers);
+    }
+    auto ownerOf = [&](const int target) {
+        return static_cast<int>(std::ranges::upper_bound(ownerBegin, target) - ownerBegin.begin()) - 1;
+    };
+
+    for (int iter = 0; iter < options.maxIterations; ++iter) {
+        for (int u = 0; u < n; ++u) {
+            reverseNew[u].clear();
+            reverseOld[u].clear();
+        }
+
+        pool.parallelFor(n, [&](const int begin, const int end) {
+            for (int u = begin; u < end; ++u) {
+                Rng rng{splitmix(options.seed ^ (static_cast<std::uint64_t>(iter + 1) << 40) ^ u)};
+                newList[u].clear();
+                oldList[u].clear();
+                Neighbor* r = lists.row(u);
+                for (int j = 0; j < k && r[j].id >= 0; ++j) {
+                    (r[j].isNew ? newList[u] : oldList[u]).push_back(j);
+                }
+                sampleInto(newList[u], sampleSize, rng);
+                for (int& slot : newList[u]) {
+                    r[slot].isNew = false;
+                    slot = r[slot].id;
+                }
+                for (int& slot : oldList[u]) slot = r[slot].id;
+            }
+        }, 256);
+
+        for (int u = 0; u < n; ++u) {
+            for (const int v : newList[u]) reverseNew[v].push_back(u);
+            for (const int v : oldList[u]) reverseOld[v].push_back(u);
+        }
+
+        pool.parallelFor(n, [&](const int begin, const int end) {
+            for (int u = begin; u < end; ++u) {
+                Rng rng{splitmix(options.seed ^ (static_cast<std::uint64_t>(iter + 1) << 20) ^ ~static_cast<std::uint64_t>(u))};
+                sampleInto(reverseNew[u], sampleSize, rng);
+                sampleInto(reverseOld[u], sampleSize, rng);
+                for (auto [list, extra] : {std::pair{&newList[u], &reverseNew[u]}, std::pair{&oldList[u], &reverseOld[u]}}) {
+                    for (const int v : *extra) {
+                        if (std::ranges::find(*list, v) == list->end()) list->push_back(v);
+                    }
+                }
+            }
+        }, 256);
+
+        std::size_t updates = 0;
+        const int blockRows = std::max(1, options.blockRows);
+        constexpr int JOIN_GRAIN = 64;
+        for (int blockBegin = 0; blockBegin < n; blockBegin += blockRows) {
+            const int blockEnd = std::min(n, blockBegin + blockRows);
+            const int chunks = (blockEnd - blockBegin + JOIN_GRAIN - 1) / JOIN_GRAIN;
+            // proposed[c][w]: updates from chunk c whose target worker w owns.
+            std::vector<std::vector<std::vector<Update>>> proposed(chunks, std::vector<std::vector<Update>>(workers));
+
+            pool.parallelFor(chunks, [&](const int cBegin, const int cEnd) {
+                std::size_t evals = 0;
+                for (int c = cBegin; c < cEnd; ++c) {
+                    auto& out = proposed[c];
+                    const int end = std::min(blockEnd, blockBegin + (c + 1) * JOIN_GRAIN);
+                    for (int u = blockBegin + c * JOIN_GRAIN; u < end; ++u) {
+                        const auto& fresh = newList[u];
+                        const auto& old = oldList[u];
+                        auto join = [&](const int a, const int b) {
+                            if (a == b) return;
+                            const double s = similarityScore(features[a], features[b]);
+                            ++evals;
+                            if (s > lists.worst(a)) out[ownerOf(a)].push_back(Update{a, b, s});
+                            if (s > lists.worst(b)) out[ownerOf(b)].push_back(Update{b, a, s});
+                        };
+                        for (std::size_t x = 0; x < fresh.size(); ++x) {
+                            for (std::size_t y = x + 1; y < fresh.size(); ++y) join(fresh[x], fresh[y]);
+                            for (const int o : old) join(fresh[x], o);
+                        }
+                    }
+                }
+                evaluations += evals;
+            }, 1);
+
+            std::atomic<std::size_t> applied{0};
+            pool.parallelFor(workers, [&](const int wBegin, const int wEnd) {
+                std::size_t count = 0;
+                for (int w = wBegin; w < wEnd; ++w) {
+                    for (const auto& chunk : proposed) {
+                        for (const Update& up : chunk[w]) {
+                            if (lists.insert(up.target, up.id, up.sim)) ++count;
+                        }
+                    }
+                }
+                applied += count;
+            }, 1);
+            updates += applied;
+        }
+
+        ++stats.iterations;
+        stats.updatesPerIteration.push_back(updates);
+        if (static_cast<double>(updates) < options.earlyStop * n * k) break;
+    }
+
+    std::vector<std::vector<std::pair<double,int>>> rows(n);
+    for (int u = 0; u < n; ++u) {
+        const Neighbor* r = lists.row(u);
+        for (int j = 0; j < k && r[j].id >= 0; ++j) {
+            if (r[j].sim > 0.0) {
+                g.addEdge(u, r[j].id, weightFromSimilarity(r[j].sim));
+                rows[u].emplace_back(r[j].sim, r[j].id);
+            }
+        }
+    }
+    g.finalize();
+    g.setKnnLists(std::move(rows), K);
+
+    stats.similarityEvaluations = evaluations;
+    return stats;
+}
+
+inline NnDescentStats buildKNNGraphNNDescent(Graph& g, const int K, const unsigned threads = defaultThreadCount(),
+                                              const NnDescentOptions& options = {}) {
+    ThreadPool pool(threads);
+    return buildKNNGraphNNDescent(g, K, pool, options);
+}
+
+
+#endif //MOVIERECOMMENDER_BUILDNNDESCENTGRAPH_H
\ No newline at end of file
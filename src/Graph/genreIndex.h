@@ -0,0 +1,92 @@
+#ifndef MOVIERECOMMENDER_GENREINDEX_H
+#define MOVIERECOMMENDER_GENREINDEX_H
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "../MoviesUtil/movieFeatures.h"
+
+// Inverted index from genre id to the movies carrying it. similarityScore is
+// 0 for two movies that both have genres but share none, so a movie's only
+// possible neighbours are the movies listed under its genres plus the movies
+// with no genres at all.
+class GenreIndex {
+public:
+    // Per-thread state for candidates(): one bit per movie, left all-zero
+    // between calls.
+    struct Scratch {
+        std::vector<std::uint64_t> bits;
+    };
+
+    explicit GenreIndex(const FeatureTable& features) : byGenre(GenreTable::MAX_GENRES) {
+        movieCount = features.size();
+        const int n = static_cast<int>(movieCount);
+        for (int i = 0; i < n; ++i) {
+            std::uint64_t mask = features.genreMasks()[i];
+            if (mask == 0) {
+                noGenre.push_back(i);
+            }
+            while (mask != 0) {
+                byGenre[std::countr_zero(mask)].push_back(i);
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    // Appends a movie added after the index was built; ids must keep
+    // increasing so the posting lists stay sorted.
+    void add(const int movie, std::uint64_t mask) {
+        if (mask == 0) {
+            noGenre.push_back(movie);
+        }
+        while (mask != 0) {
+            byGenre[std::countr_zero(mask)].push_back(movie);
+            mask &= mask - 1;
+        }
+        movieCount = static_cast<std::size_t>(movie) + 1;
+    }
+
+    [[nodiscard]] std::size_t size() const { return movieCount; }
+
+    // Sum of the posting lists candidates() would merge for this mask.
+    [[nodiscard]] std::size_t candidateBound(std::uint64_t mask) const {
+        std::size_t total = noGenre.size();
+        while (mask != 0) {
+            total += byGenre[std::countr_zero(mask)].size();
+            mask &= mask - 1;
+        }
+        return total;
+    }
+
+    // Ascending indices of every movie that may score above 0 against a movie
+    // with this (non-empty) mask, excluding `self`. Postings are OR-ed into a
+    // bitset and read back word by word, which yields them sorted and
+    // de-duplicated without a sort.
+    void candidates(std::uint64_t mask, const int self, std::vector<int>& out, Scratch& scratch) const {
+        auto& bits = scratch.bits;
+        if (bits.size() * 64 < movieCount) bits.assign((movieCount + 63) / 64, 0);
+
+        auto set = [&](const int j) { bits[j >> 6] |= std::uint64_t{1} << (j & 63); };
+        while (mask != 0) {
+            for (const int j : byGenre[std::countr_zero(mask)]) set(j);
+            mask &= mask - 1;
+        }
+        for (const int j : noGenre) set(j);
+        bits[self >> 6] &= ~(std::uint64_t{1} << (self & 63));
+
+        out.clear();
+        for (std::size_t w = 0; w < bits.size(); ++w) {
+            for (std::uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                out.push_back(static_cast<int>(w * 64) + std::countr_zero(word));
+            }
+            bits[w] = 0;
+        }
+    }
+
+private:
+    std::vector<std::vector<int>> byGenre;
+    std::vector<int> noGenre;
+    std::size_t movieCount = 0;
+};
+
+
+#endif //MOVIERECOMMENDER_GENREINDEX_H
\ No newline at end of file
@@ -1,5 +1,57 @@
 #include "graph.h"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include "../MoviesUtil/similarityScore.h"
+
+CsrAdjacency::CsrAdjacency(std::vector<std::uint64_t> offsets, std::vector<Edge> edges)
+    : ownedOffsets(std::move(offsets)),
+      ownedEdges(std::move(edges)) {
+    rebind();
+}
+
+CsrAdjacency::CsrAdjacency(const std::span<const std::uint64_t> offsets, const std::span<const Edge> edges,
+                           std::shared_ptr<const void> backing)
+    : backing(std::move(backing)),
+      offsetsOwned(false),
+      edgesOwned(false),
+      offsetView(offsets),
+      edgeView(edges) {
+}
+
+CsrAdjacency::CsrAdjacency(const CsrAdjacency& other)
+    : ownedOffsets(other.ownedOffsets),
+      ownedEdges(other.ownedEdges),
+      backing(other.backing),
+      offsetsOwned(other.offsetsOwned),
+      edgesOwned(other.edgesOwned),
+      offsetView(other.offsetView),
+      edgeView(other.edgeView) {
+    rebind();
+}
+
+CsrAdjacency& CsrAdjacency::operator=(const CsrAdjacency& other) {
+    if (this != &other) {
+        CsrAdjacency copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+void CsrAdjacency::appendEmptyRow() {
+    if (!offsetsOwned) {
+        ownedOffsets.assign(offsetView.begin(), offsetView.end());
+        offsetsOwned = true;
+    }
+    ownedOffsets.push_back(ownedOffsets.empty() ? 0 : ownedOffsets.back());
+    rebind();
+}
+
+void CsrAdjacency::rebind() {
+    if (offsetsOwned) offsetView = ownedOffsets;
+    if (edgesOwned) edgeView = ownedEdges;
+}
 
 int Graph::addMovie(const Movie& movie) {
     const int id = movie.tmdbId;
@@ -15,16 +67,33 @@ int Graph::addMovie(const Movie& movie) {
     }
 
     const int idx = static_cast<int>(movies.size());
+    features.push_back(makeFeatures(movie, genreTable));
     movies.push_back(movie);
-    adj.emplace_back();
+    if (finalized) {
+        csr.appendEmptyRow();
+    } else {
+        adj.emplace_back();
+    }
     idToIndex[id] = idx;
+    bumpVersion();
 
     return idx;
 }
 
 void Graph::addEdge(const int from, const int to, const double weight) {
+    if (finalized) {
+        thaw();
+    }
+    knnLists.clear();
+    linkEdge(from, to, weight);
+}
+
+void Graph::linkEdge(const int from, const int to, const double weight) {
     adj[from].push_back(Edge{to, weight});
     adj[to].push_back(Edge{from, weight});
+    minWeight = std::min(minWeight, weight);
+    maxWeight = std::max(maxWeight, weight);
+    bumpVersion();
 }
 
 int Graph::indexOf(const int &tmdbId) {
@@ -32,12 +101,152 @@ int Graph::indexOf(const int &tmdbId) {
     return it == idToIndex.end() ? -1 : it->second;
 }
 
-std::vector<Movie> Graph::getMovies() const{
-    return movies;
+void Graph::finalize() {
+    if (finalized) return;
+
+    // addEdge stores both directions, so a pair inserted from each side
+    // (i and j in each other's top-K) shows up twice per row. Keep the first
+    // occurrence of each neighbour, with the smallest weight seen for it.
+    const std::size_t n = adj.size();
+    std::vector<std::uint64_t> offsets(n + 1, 0);
+    std::vector<Edge> edges;
+    std::vector<std::size_t> slot(n, 0);
+    std::vector<int> slotOwner(n, -1);
+
+    for (std::size_t u = 0; u < n; ++u) {
+        for (const Edge& e : adj[u]) {
+            if (slotOwner[e.to] == static_cast<int>(u)) {
+                double& w = edges[slot[e.to]].weight;
+                w = std::min(w, e.weight);
+                continue;
+            }
+            slotOwner[e.to] = static_cast<int>(u);
+            slot[e.to] = edges.size();
+            edges.push_back(e);
+        }
+        offsets[u + 1] = edges.size();
+    }
+    edges.shrink_to_fit();
+
+    csr = CsrAdjacency(std::move(offsets), std::move(edges));
+    std::vector<std::vector<Edge>>().swap(adj);
+    finalized = true;
+}
+
+void Graph::adoptCsr(CsrAdjacency adjacency, const double minEdgeWeight, const double maxEdgeWeight) {
+    csr = std::move(adjacency);
+    std::vector<std::vector<Edge>>().swap(adj);
+    minWeight = minEdgeWeight;
+    maxWeight = maxEdgeWeight;
+    finalized = true;
+    bumpVersion();
 }
 
-std::vector<std::vector<Edge>> Graph::getAdj() const {
-    return adj;
+void Graph::thaw() {
+    const std::size_t n = movies.size();
+    adj.assign(n, {});
+    for (std::size_t u = 0; u < n; ++u) {
+        const auto nbrs = csr.neighbors(static_cast<int>(u));
+        adj[u].assign(nbrs.begin(), nbrs.end());
+    }
+
+    csr = CsrAdjacency();
+    finalized = false;
+}
+
+std::size_t Graph::edgeCount() const {
+    if (finalized) return csr.edgeCount();
+
+    std::size_t total = 0;
+    for (const auto& nbrs : adj) total += nbrs.size();
+    return total;
+}
+
+void Graph::setKnnLists(std::vector<std::vector<std::pair<double,int>>> lists, const int K) {
+    for (auto& list : lists) {
+        std::ranges::sort(list, [](const auto& a, const auto& b) { return a.first > b.first; });
+    }
+    knnLists = std::move(lists);
+    knnK = K;
+}
+
+// The lists can only come from the builder: rescoring the edges here would
+// use the content score alone, which is not what chose a blended graph's
+// rows.
+void Graph::ensureKnnLists(const int K) const {
+    if (knnK != K || knnLists.size() != movies.size()) {
+        throw std::runtime_error("insertMovieIncremental needs the top-" + std::to_string(K)
+                                 + " lists from the KNN builder; rebuild the graph first");
+    }
+}
+
+// minWeight/maxWeight are left as they are: still valid bounds.
+void Graph::unlinkEdge(const int from, const int to) {
+    std::erase_if(adj[from], [to](const Edge& e) { return e.to == to; });
+    std::erase_if(adj[to], [from](const Edge& e) { return e.to == from; });
+    bumpVersion();
+}
+
+int Graph::insertMovieIncremental(const Movie& movie, const int K) {
+    if (const int existing = indexOf(movie.tmdbId); existing != -1) return existing;
+
+    ensureKnnLists(K);
+    if (!candidateIndex || candidateIndex->size() != movies.size()) {
+        candidateIndex.emplace(features);
+    }
+
+    const int x = addMovie(movie);
+    if (x < 0) return x;
+    if (finalized) thaw();
+    candidateIndex->add(x, features.genreMasks()[x]);
+
+    const MovieFeatures fx = features[x];
+    auto& candidates = candidateBuffer;
+    if (fx.genreMask != 0 && candidateIndex->candidateBound(fx.genreMask) * 2 < static_cast<std::size_t>(x)) {
+        candidateIndex->candidates(fx.genreMask, x, candidates, candidateScratch);
+    } else {
+        candidates.resize(x);
+        for (int j = 0; j < x; ++j) candidates[j] = j;
+    }
+
+    auto stronger = [](const auto& a, const auto& b) { return a.first > b.first; };
+    std::vector<std::pair<double,int>> scored;
+    for (const int j : candidates) {
+        if (const double sim = similarityScore(fx, features[j]); sim > 0.0) scored.emplace_back(sim, j);
+    }
+
+    // Reverse KNN: x enters the list of every candidate it beats.
+    for (const auto& [sim, j] : scored) {
+        auto& list = knnLists[j];
+        if (static_cast<int>(list.size()) == K && sim <= list.back().first) continue;
+
+        list.insert(std::ranges::upper_bound(list, std::pair{sim, x}, stronger), {sim, x});
+        linkEdge(j, x, weightFromSimilarity(sim));
+        if (static_cast<int>(list.size()) > K) {
+            const int evicted = list.back().second;
+            list.pop_back();
+            const auto& other = knnLists[evicted];
+            if (std::ranges::find(other, j, &std::pair<double,int>::second) == other.end()) {
+                unlinkEdge(j, evicted);
+            }
+        }
+    }
+
+    if (static_cast<int>(scored.size()) > K) {
+        std::ranges::nth_element(scored, scored.begin() + K, stronger);
+        scored.resize(K);
+    }
+    std::ranges::sort(scored, stronger);
+    for (const auto& [sim, j] : scored) {
+        const auto& theirs = knnLists[j];
+        if (std::ranges::find(theirs, x, &std::pair<double,int>::second) == theirs.end()) {
+            linkEdge(x, j, weightFromSimilarity(sim));
+        }
+    }
+
+    knnLists.push_back(std::move(scored));
+    knnK = K;
+    return x;
 }
 
 
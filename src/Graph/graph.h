@@ -1,27 +1,159 @@
 #ifndef MOVIERECOMMENDER_GRAPH_H
 #define MOVIERECOMMENDER_GRAPH_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "../MoviesUtil/Movie.h"
+#include "../MoviesUtil/movieFeatures.h"
+#include "./genreIndex.h"
 
 struct Edge {
     int to;
     double weight;
 };
 
+// Copying a Graph duplicates every movie and edge. The counter lets callers
+// check that a code path (the query path in particular) never does that.
+struct GraphCopyCounter {
+    static inline std::atomic<std::size_t> copies{0};
+
+    GraphCopyCounter() = default;
+    GraphCopyCounter(const GraphCopyCounter&) { ++copies; }
+    GraphCopyCounter(GraphCopyCounter&&) noexcept = default;
+    GraphCopyCounter& operator=(const GraphCopyCounter&) { ++copies; return *this; }
+    GraphCopyCounter& operator=(GraphCopyCounter&&) noexcept = default;
+};
+
+// Frozen adjacency in CSR form: edges of u are
+// edges[offsets[u] .. offsets[u + 1]) in one contiguous array. Each array is
+// either owned or borrowed from external storage (a mapped graph file) that
+// `backing` keeps alive.
+class CsrAdjacency {
+public:
+    CsrAdjacency() = default;
+    CsrAdjacency(std::vector<std::uint64_t> offsets, std::vector<Edge> edges);
+    CsrAdjacency(std::span<const std::uint64_t> offsets, std::span<const Edge> edges,
+                 std::shared_ptr<const void> backing);
+
+    CsrAdjacency(const CsrAdjacency& other);
+    CsrAdjacency(CsrAdjacency&&) noexcept = default;
+    CsrAdjacency& operator=(const CsrAdjacency& other);
+    CsrAdjacency& operator=(CsrAdjacency&&) noexcept = default;
+
+    [[nodiscard]] std::span<const Edge> neighbors(const int u) const {
+        return edgeView.subspan(offsetView[u], offsetView[u + 1] - offsetView[u]);
+    }
+
+    [[nodiscard]] std::size_t edgeCount() const { return edgeView.size(); }
+    [[nodiscard]] std::span<const std::uint64_t> offsets() const { return offsetView; }
+    [[nodiscard]] std::span<const Edge> edges() const { return edgeView; }
+
+    void appendEmptyRow();
+
+private:
+    std::vector<std::uint64_t> ownedOffsets;
+    std::vector<Edge> ownedEdges;
+    std::shared_ptr<const void> backing;
+    bool offsetsOwned = true;
+    bool edgesOwned = true;
+    std::span<const std::uint64_t> offsetView;
+    std::span<const Edge> edgeView;
+
+    void rebind();
+};
+
+// Adjacency is collected in per-movie lists while the graph is being built.
+// finalize() freezes it into CSR form, merging parallel edges so each
+// undirected edge is stored once per endpoint. adoptCsr() installs a frozen
+// CSR as-is, such as one read back from a saved graph.
 class Graph {
 
 public:
     int addMovie(const Movie &movie);
     void addEdge(int from, int to, double weight);
     int indexOf(const int &imdbId);
-    [[nodiscard]] std::vector<Movie> getMovies() const;
-    [[nodiscard]] std::vector<std::vector<Edge>> getAdj() const;
+    void finalize();
+    void adoptCsr(CsrAdjacency adjacency, double minEdgeWeight, double maxEdgeWeight);
+
+    // Each movie's own top-K (similarity, neighbour) list, best first, as
+    // chosen by the KNN builder. Edges are the union of these lists.
+    void setKnnLists(std::vector<std::vector<std::pair<double,int>>> lists, int K);
+    // Movie u's list; empty when the builder set none.
+    [[nodiscard]] std::span<const std::pair<double,int>> knnList(const int u) const {
+        if (static_cast<std::size_t>(u) >= knnLists.size()) return {};
+        return knnLists[u];
+    }
+
+    // Adds a movie and links it into the KNN graph without a rebuild: its
+    // neighbours come from the genre index, and every candidate whose own
+    // top-K it beats takes it in, dropping that list's worst entry (and the
+    // edge, unless the other side still lists it). Returns the movie's index.
+    // The first insert into a finalized graph thaws it back into lists,
+    // which is O(edges); later ones only touch the lists involved. Leave the
+    // graph in list form between inserts: finalize() rebuilds the whole CSR.
+    // Needs the top-K lists a KNN builder leaves behind, with the same K;
+    // throws std::runtime_error otherwise (a loaded graph, or one changed
+    // through addEdge).
+    int insertMovieIncremental(const Movie& movie, int K);
+
+    [[nodiscard]] bool isFinalized() const { return finalized; }
+    // Changes whenever movies or edges do. Values are unique across Graph
+    // instances, so a (graph version, query) key never matches another graph.
+    [[nodiscard]] std::uint64_t version() const { return graphVersion; }
+    [[nodiscard]] int size() const { return static_cast<int>(movies.size()); }
+    [[nodiscard]] std::size_t edgeCount() const;
+    [[nodiscard]] double minEdgeWeight() const { return minWeight; }
+    [[nodiscard]] double maxEdgeWeight() const { return maxWeight; }
+
+    [[nodiscard]] std::span<const Edge> neighbors(const int u) const {
+        if (finalized) {
+            return csr.neighbors(u);
+        }
+        return adj[u];
+    }
+
+    [[nodiscard]] const CsrAdjacency& getCsr() const { return csr; }
+
+    [[nodiscard]] std::span<const Movie> getMovies() const { return movies; }
+    [[nodiscard]] const Movie& getMovie(const int i) const { return movies[i]; }
+    [[nodiscard]] const FeatureTable& getFeatures() const { return features; }
+    [[nodiscard]] const GenreTable& getGenres() const { return genreTable; }
+
+    [[nodiscard]] static std::size_t deepCopyCount() { return GraphCopyCounter::copies.load(); }
 
 private:
     std::vector<Movie> movies;
+    FeatureTable features;
+    GenreTable genreTable;
     std::vector<std::vector<Edge>> adj;
+    CsrAdjacency csr;
+    bool finalized = false;
+    double minWeight = std::numeric_limits<double>::infinity();
+    double maxWeight = 0.0;
     std::unordered_map<int, int> idToIndex;
+    GraphCopyCounter copyCounter;
+
+    static inline std::atomic<std::uint64_t> versionCounter{0};
+    std::uint64_t graphVersion = ++versionCounter;
+
+    std::vector<std::vector<std::pair<double,int>>> knnLists;
+    int knnK = 0;
+    std::optional<GenreIndex> candidateIndex;
+    GenreIndex::Scratch candidateScratch;
+    std::vector<int> candidateBuffer;
+
+    void thaw();
+    void bumpVersion() { graphVersion = ++versionCounter; }
+    void ensureKnnLists(int K) const;
+    void linkEdge(int from, int to, double weight);
+    void unlinkEdge(int from, int to);
 };
 
 #endif //MOVIERECOMMENDER_GRAPH_H
\ No newline at end of file
@@ -1,12 +1,28 @@
 #ifndef MOVIERECOMMENDER_LOADGRAPH_H
 #define MOVIERECOMMENDER_LOADGRAPH_H
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <nlohmann/json.hpp>
 #include "./graph.h"
 #include "../MoviesUtil/Movie.h"
 
-inline Graph loadGraphFromDisk(const std::string& path) {
+namespace load_graph_detail {
+    // Dijkstra needs positive weights, and the bucket queue divides by the
+    // smallest one.
+    inline void checkWeight(const double weight, const std::size_t row, const int to) {
+        if (!std::isfinite(weight) || !(weight > 0.0)) {
+            throw std::runtime_error("Invalid edge weight " + std::to_string(weight) + " in adj at row "
+                                     + std::to_string(row) + " (to " + std::to_string(to) + ")");
+        }
+    }
+}
+
+// Reference loader: parses the whole file into a json DOM, then walks it.
+inline Graph loadGraphFromDiskDom(const std::string& path) {
     std::ifstream in(path);
     if (!in.is_open()) {
         throw std::runtime_error("Failed to open graph file: " + path);
@@ -47,6 +63,13 @@ inline Graph loadGraphFromDisk(const std::string& path) {
         throw std::runtime_error("Graph 'adj' size does not match 'movies' size");
     }
 
+    // The saved rows already hold both directions of every edge, so they are
+    // adopted as they are rather than replayed through addEdge.
+    std::vector<std::uint64_t> offsets(n + 1, 0);
+    std::vector<Edge> edges;
+    double minWeight = std::numeric_limits<double>::infinity();
+    double maxWeight = 0.0;
+
     for (std::size_t i = 0; i < n; ++i) {
         const auto& row = adjJson[i];
         if (!row.is_array()) {
@@ -60,12 +83,228 @@ inline Graph loadGraphFromDisk(const std::string& path) {
             if (to < 0 || static_cast<std::size_t>(to) >= n) {
                 throw std::runtime_error("Invalid 'to' index in adj at row " + std::to_string(i));
             }
+            load_graph_detail::checkWeight(weight, i, to);
 
-            g.addEdge(static_cast<int>(i), to, weight);
+            edges.push_back(Edge{to, weight});
+            minWeight = std::min(minWeight, weight);
+            maxWeight = std::max(maxWeight, weight);
         }
+        offsets[i + 1] = edges.size();
     }
 
+    g.adoptCsr(CsrAdjacency(std::move(offsets), std::move(edges)), minWeight, maxWeight);
     return g;
 }
 
+namespace load_graph_detail {
+    // SAX handler that fills the graph as tokens arrive. Container depth
+    // locates each value: movies are objects at depth 3, adjacency rows are
+    // arrays at depth 3 and edges are objects at depth 4. Unknown keys and
+    // anything nested deeper are ignored. Keys may appear in either order
+    // ("adj" sorts before "movies"), so edge targets are checked at the end.
+    class GraphSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+    public:
+        Graph finish() {
+            if (!seenMovies) {
+                throw std::runtime_error("Graph file missing 'movies' array");
+            }
+            if (!seenAdj) {
+                throw std::runtime_error("Graph file missing 'adj' array");
+            }
+
+            const std::size_t n = g.getMovies().size();
+            if (offsets.size() - 1 != n) {
+                throw std::runtime_error("Graph 'adj' size does not match 'movies' size");
+            }
+
+            double minWeight = std::numeric_limits<double>::infinity();
+            double maxWeight = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t e = offsets[i]; e < offsets[i + 1]; ++e) {
+                    if (edges[e].to < 0 || static_cast<std::size_t>(edges[e].to) >= n) {
+                        throw std::runtime_error("Invalid 'to' index in adj at row " + std::to_string(i));
+                    }
+                    checkWeight(edges[e].weight, i, edges[e].to);
+                    minWeight = std::min(minWeight, edges[e].weight);
+                    maxWeight = std::max(maxWeight, edges[e].weight);
+                }
+            }
+
+            g.adoptCsr(CsrAdjacency(std::move(offsets), std::move(edges)), minWeight, maxWeight);
+            return std::move(g);
+        }
+
+        bool null() override { return scalar(); }
+        bool boolean(bool) override { return scalar(); }
+        bool number_integer(const number_integer_t v) override { return number(static_cast<double>(v)); }
+        bool number_unsigned(const number_unsigned_t v) override { return number(static_cast<double>(v)); }
+        bool number_float(const number_float_t v, const string_t&) override { return number(v); }
+        bool binary(binary_t&) override { return scalar(); }
+
+        bool string(string_t& v) override {
+            if (section == Section::Movies && depth == 3 && fieldKey == "title") {
+                movie.name = std::move(v);
+                hasTitle = true;
+                return true;
+            }
+            if (section == Section::Movies && depth == 4 && fieldKey == "genres") {
+                movie.genres.push_back(std::move(v));
+                return true;
+            }
+            return scalar();
+        }
+
+        bool key(string_t& k) override {
+            if (depth == 1) {
+                topKey = std::move(k);
+            } else if ((section == Section::Movies && depth == 3) || (section == Section::Adj && depth == 4)) {
+                fieldKey = std::move(k);
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) override {
+            ++depth;
+            if (section == Section::Movies && depth == 3) {
+                movie = Movie{};
+                hasId = hasTitle = false;
+            } else if (section == Section::Adj && depth == 3) {
+                throw std::runtime_error("Graph 'adj' row is not an array at index " + std::to_string(offsets.size() - 1));
+            } else if (section == Section::Adj && depth == 4) {
+                hasTo = hasWeight = false;
+            }
+            return true;
+        }
+
+        bool end_object() override {
+            if (section == Section::Movies && depth == 3) {
+                if (!hasId || !hasTitle) {
+                    throw std::runtime_error("Graph movie missing 'tmdbId' or 'title'");
+                }
+                g.addMovie(movie);
+            } else if (section == Section::Adj && depth == 4) {
+                if (!hasTo || !hasWeight) {
+                    throw std::runtime_error("Graph edge missing 'to' or 'w' at row " + std::to_string(offsets.size() - 1));
+                }
+                edges.push_back(edge);
+            }
+            --depth;
+            return true;
+        }
+
+        bool start_array(std::size_t) override {
+            ++depth;
+            if (depth == 1) {
+                throw std::runtime_error("Graph file missing 'movies' array");
+            }
+            if (depth == 2 && topKey == "movies") {
+                section = Section::Movies;
+                seenMovies = true;
+            } else if (depth == 2 && topKey == "adj") {
+                section = Section::Adj;
+                seenAdj = true;
+            } else if (section == Section::Movies && depth == 3) {
+                throw std::runtime_error("Graph 'movies' entry is not an object");
+            } else if (section == Section::Movies && depth == 4 && fieldKey == "genres") {
+                movie.genres.clear();
+            } else if (section == Section::Adj && depth == 4) {
+                throw std::runtime_error("Graph edge is not an object at row " + std::to_string(offsets.size() - 1));
+            }
+            return true;
+        }
+
+        bool end_array() override {
+            if (section == Section::Adj && depth == 3) {
+                offsets.push_back(edges.size());
+            } else if (depth == 2) {
+                section = Section::None;
+            }
+            --depth;
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+            throw std::runtime_error(std::string("Failed to parse graph file: ") + ex.what());
+        }
+
+    private:
+        enum class Section { None, Movies, Adj };
+
+        Graph g;
+        Section section = Section::None;
+        int depth = 0;
+        std::string topKey;
+        std::string fieldKey;
+        bool seenMovies = false;
+        bool seenAdj = false;
+
+        Movie movie;
+        bool hasId = false;
+        bool hasTitle = false;
+
+        Edge edge{};
+        bool hasTo = false;
+        bool hasWeight = false;
+        std::vector<std::uint64_t> offsets{0};
+        std::vector<Edge> edges;
+
+        bool number(const double v) {
+            if (section == Section::Movies && depth == 3) {
+                if (fieldKey == "tmdbId") {
+                    movie.tmdbId = static_cast<int>(v);
+                    hasId = true;
+                } else if (fieldKey == "rating") {
+                    movie.rating = v;
+                } else if (fieldKey == "year") {
+                    movie.year = static_cast<int>(v);
+                } else if (fieldKey == "title") {
+                    throw std::runtime_error("Graph movie 'title' is not a string");
+                }
+                return true;
+            }
+            if (section == Section::Adj && depth == 4) {
+                if (fieldKey == "to") {
+                    edge.to = static_cast<int>(v);
+                    hasTo = true;
+                } else if (fieldKey == "w") {
+                    edge.weight = v;
+                    hasWeight = true;
+                }
+                return true;
+            }
+            return scalar();
+        }
+
+        // Bare values where a movie, a row or an edge is expected are errors.
+        [[nodiscard]] bool scalar() const {
+            if (depth == 0) {
+                throw std::runtime_error("Graph file missing 'movies' array");
+            }
+            if (section == Section::Movies && depth == 2) {
+                throw std::runtime_error("Graph 'movies' entry is not an object");
+            }
+            if (section == Section::Adj && depth == 2) {
+                throw std::runtime_error("Graph 'adj' row is not an array at index " + std::to_string(offsets.size() - 1));
+            }
+            if (section == Section::Adj && depth == 3) {
+                throw std::runtime_error("Graph edge is not an object at row " + std::to_string(offsets.size() - 1));
+            }
+            return true;
+        }
+    };
+}
+
+// Streams the file through the SAX interface, so no json DOM is built and
+// peak memory stays close to the size of the finished graph.
+inline Graph loadGraphFromDisk(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open graph file: " + path);
+    }
+
+    load_graph_detail::GraphSaxHandler handler;
+    nlohmann::json::sax_parse(in, &handler);
+    return handler.finish();
+}
+
 #endif //MOVIERECOMMENDER_LOADGRAPH_H
\ No newline at end of file
@@ -1,16 +1,21 @@
 #ifndef MOVIERECOMMENDER_SAVEGRAPH_H
 #define MOVIERECOMMENDER_SAVEGRAPH_H
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
 #include <fstream>
 #include <stdexcept>
+#include <string>
 #include <nlohmann/json.hpp>
-#include "Graph.h"
+#include "graph.h"
 #include "../MoviesUtil/Movie.h"
 
-inline void saveGraphToDisk(const Graph& g, const std::string& path) {
+// Reference writer: builds the whole document as a json DOM, then dumps it.
+inline void saveGraphToDiskDom(const Graph& g, const std::string& path) {
     nlohmann::json j;
 
-    const auto& movies = g.getMovies();
-    const auto& adj    = g.getAdj();
+    const auto movies = g.getMovies();
 
     j["movies"] = nlohmann::json::array();
 
@@ -24,16 +29,12 @@ inline void saveGraphToDisk(const Graph& g, const std::string& path) {
         j["movies"].push_back(jm);
     }
 
-    if (adj.size() != movies.size()) {
-        throw std::runtime_error("saveGraphToDisk: adj size does not match movies size");
-    }
-
     j["adj"] = nlohmann::json::array();
 
-    for (const auto& nbrs : adj) {
+    for (int u = 0; u < g.size(); ++u) {
         nlohmann::json row = nlohmann::json::array();
 
-        for (const auto& e : nbrs) {
+        for (const auto& e : g.neighbors(u)) {
             nlohmann::json je;
             je["to"] = e.to;
             je["w"]  = e.weight;
@@ -51,4 +52,163 @@ inline void saveGraphToDisk(const Graph& g, const std::string& path) {
     out << j.dump(2) << '\n';
 }
 
+namespace save_graph_detail {
+    // Appends JSON text to a fixed-size buffer and hands it to the file
+    // whenever it fills, so memory stays bounded whatever the graph size.
+    class JsonChunkWriter {
+    public:
+        static constexpr std::size_t CHUNK_BYTES = 1 << 20;
+
+        explicit JsonChunkWriter(std::ofstream& out) : out(out) { buffer.reserve(CHUNK_BYTES); }
+
+        void raw(const std::string_view s) {
+            if (buffer.size() + s.size() > CHUNK_BYTES) flush();
+            if (s.size() > CHUNK_BYTES) {
+                out.write(s.data(), static_cast<std::streamsize>(s.size()));
+                written += s.size();
+                return;
+            }
+            buffer.append(s);
+        }
+
+        void raw(const char c) {
+            if (buffer.size() == CHUNK_BYTES) flush();
+            buffer.push_back(c);
+        }
+
+        // Shortest text that reads back as the same double. JSON has no
+        // nan/inf, so those are written as null, like the DOM writer does.
+        void number(const double v) {
+            if (!std::isfinite(v)) {
+                raw("null");
+                return;
+            }
+            char text[32];
+            const auto [end, ec] = std::to_chars(text, text + sizeof(text), v);
+            raw(std::string_view(text, end - text));
+        }
+
+        void number(const int v) {
+            char text[16];
+            const auto [end, ec] = std::to_chars(text, text + sizeof(text), v);
+            raw(std::string_view(text, end - text));
+        }
+
+        void string(const std::string& s) {
+            raw(nlohmann::json(s).dump());
+        }
+
+        void newline(const bool pretty, const int indent) {
+            if (!pretty) return;
+            raw('\n');
+            for (int i = 0; i < indent; ++i) raw("  ");
+        }
+
+        void flush() {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            written += buffer.size();
+            buffer.clear();
+        }
+
+        [[nodiscard]] std::size_t bytesWritten() const { return written; }
+
+    private:
+        std::ofstream& out;
+        std::string buffer;
+        std::size_t written = 0;
+    };
+}
+
+// Streams movies and then adjacency rows to the file in bounded memory.
+// Compact JSON by default; pretty adds newlines and two-space indentation.
+// The file is written next to `path` and renamed over it, so an interrupted
+// save leaves the previous file intact. Returns the number of bytes written.
+inline std::size_t saveGraphToDisk(const Graph& g, const std::string& path, const bool pretty = false) {
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("saveGraphToDisk: failed to open file: " + tmpPath);
+    }
+
+    save_graph_detail::JsonChunkWriter w(out);
+    const char* sep = pretty ? ": " : ":";
+    const char* comma = pretty ? ", " : ",";
+
+    w.raw('{');
+    w.newline(pretty, 1);
+    w.raw("\"movies\"");
+    w.raw(sep);
+    w.raw('[');
+    const auto movies = g.getMovies();
+    for (std::size_t i = 0; i < movies.size(); ++i) {
+        const Movie& m = movies[i];
+        if (i > 0) w.raw(',');
+        w.newline(pretty, 2);
+        w.raw("{\"tmdbId\"");
+        w.raw(sep);
+        w.number(m.tmdbId);
+        w.raw(comma);
+        w.raw("\"title\"");
+        w.raw(sep);
+        w.string(m.name);
+        w.raw(comma);
+        w.raw("\"genres\"");
+        w.raw(sep);
+        w.raw('[');
+        for (std::size_t k = 0; k < m.genres.size(); ++k) {
+            if (k > 0) w.raw(comma);
+            w.string(m.genres[k]);
+        }
+        w.raw(']');
+        w.raw(comma);
+        w.raw("\"rating\"");
+        w.raw(sep);
+        w.number(m.rating);
+        w.raw(comma);
+        w.raw("\"year\"");
+        w.raw(sep);
+        w.number(m.year);
+        w.raw('}');
+    }
+    if (!movies.empty()) w.newline(pretty, 1);
+    w.raw("],");
+
+    w.newline(pretty, 1);
+    w.raw("\"adj\"");
+    w.raw(sep);
+    w.raw('[');
+    for (int u = 0; u < g.size(); ++u) {
+        if (u > 0) w.raw(',');
+        w.newline(pretty, 2);
+        w.raw('[');
+        bool first = true;
+        for (const auto& e : g.neighbors(u)) {
+            if (!first) w.raw(comma);
+            first = false;
+            w.raw("{\"to\"");
+            w.raw(sep);
+            w.number(e.to);
+            w.raw(comma);
+            w.raw("\"w\"");
+            w.raw(sep);
+            w.number(e.weight);
+            w.raw('}');
+        }
+        w.raw(']');
+    }
+    if (g.size() > 0) w.newline(pretty, 1);
+    w.raw(']');
+    w.newline(pretty, 0);
+    w.raw("}\n");
+    w.flush();
+
+    out.close();
+    if (!out) {
+        std::filesystem::remove(tmpPath);
+        throw std::runtime_error("saveGraphToDisk: failed writing file: " + tmpPath);
+    }
+    std::filesystem::rename(tmpPath, path);
+    return w.bytesWritten();
+}
+
 #endif //MOVIERECOMMENDER_SAVEGRAPH_H
\ No newline at end of file
@@ -1,16 +1,17 @@
 #ifndef MOVIERECOMMENDER_HEAPTOPK_H
 #define MOVIERECOMMENDER_HEAPTOPK_H
 
+#include <array>
 #include <vector>
 #include <queue>
 #include <functional>
 #include <algorithm>
-#include "../MoviesUtil/Movie.h"
+#include "../MoviesUtil/movieFeatures.h"
 #include "../MoviesUtil/similarityScore.h"
+#include "../MoviesUtil/similarityBatch.h"
 
 inline std::vector<int> heapTopKRecommendations(
-    const Movie& sourceMovie,
-    const std::vector<Movie>& allMovies,
+    const FeatureTable& features,
     int sourceIndex,
     int k) {
 
@@ -18,19 +19,29 @@ inline std::vector<int> heapTopKRecommendations(
     std::priority_queue<HeapElement, std::vector<HeapElement>, 
                        std::greater<HeapElement>> minHeap;
 
-    for (int i = 0; i < static_cast<int>(allMovies.size()); ++i) {
-        if (i == sourceIndex) continue;
-        
-        const Movie& targetMovie = allMovies[i];
-        double similarity = similarityScore(sourceMovie, targetMovie);
+    const MovieFeatures source = features[sourceIndex];
+    const int n = static_cast<int>(features.size());
 
-        if (static_cast<int>(minHeap.size()) < k) {
-            minHeap.push({similarity, i});
-        } 
+    constexpr int BLOCK = 256;
+    std::array<double, BLOCK> scores{};
 
-        else if (similarity > minHeap.top().first) {
-            minHeap.pop();
-            minHeap.push({similarity, i});
+    for (int begin = 0; begin < n; begin += BLOCK) {
+        const int end = std::min(n, begin + BLOCK);
+        scoreBatch(source, features, begin, end, scores.data());
+
+        for (int i = begin; i < end; ++i) {
+            if (i == sourceIndex) continue;
+
+            double similarity = scores[i - begin];
+
+            if (static_cast<int>(minHeap.size()) < k) {
+                minHeap.push({similarity, i});
+            }
+
+            else if (similarity > minHeap.top().first) {
+                minHeap.pop();
+                minHeap.push({similarity, i});
+            }
         }
     }
 
@@ -0,0 +1,98 @@
+#ifndef MOVIERECOMMENDER_CSV_H
+#define MOVIERECOMMENDER_CSV_H
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Returns `text` without its first line (the CSV header).
+inline std::string_view skipFirstLine(const std::string_view text) {
+    const std::size_t nl = text.find('\n');
+    return nl == std::string_view::npos ? std::string_view{} : text.substr(nl + 1);
+}
+
+// Splits `text` into at most `parts` pieces of similar size. Every cut is
+// moved forward to just after a newline, so each piece holds whole lines.
+inline std::vector<std::string_view> splitLines(const std::string_view text, const std::size_t parts) {
+    std::vector<std::string_view> chunks;
+    if (text.empty()) return chunks;
+
+    const std::size_t target = std::max<std::size_t>(1, text.size() / std::max<std::size_t>(1, parts));
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        std::size_t end = std::min(text.size(), begin + target);
+        if (end < text.size()) {
+            const std::size_t nl = text.find('\n', end - 1);
+            end = nl == std::string_view::npos ? text.size() : nl + 1;
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Walks comma-separated fields line by line. Quoted fields may contain
+// commas and "" escapes; only those are copied (into the caller's scratch),
+// every other field is a view into the input.
+class CsvCursor {
+public:
+    explicit CsvCursor(const std::string_view text) : p(text.data()), end(text.data() + text.size()) {}
+
+    [[nodiscard]] bool done() const { return p >= end; }
+
+    std::string_view field(std::string& scratch) {
+        if (p < end && *p == '"') {
+            ++p;
+            const char* start = p;
+            bool escaped = false;
+            while (p < end) {
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') {
+                        escaped = true;
+                        p += 2;
+                        continue;
+                    }
+                    break;
+                }
+                ++p;
+            }
+            std::string_view value(start, p - start);
+            if (p < end) ++p;
+            if (p < end && *p == ',') ++p;
+            if (!escaped) return value;
+
+            scratch.clear();
+            for (std::size_t i = 0; i < value.size(); ++i) {
+                scratch.push_back(value[i]);
+                if (value[i] == '"') ++i;
+            }
+            return scratch;
+        }
+
+        const char* start = p;
+        while (p < end && *p != ',' && *p != '\n' && *p != '\r') ++p;
+        std::string_view value(start, p - start);
+        if (p < end && *p == ',') ++p;
+        return value;
+    }
+
+    void nextLine() {
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+    }
+
+private:
+    const char* p;
+    const char* end;
+};
+
+template<class T>
+bool parseNumber(const std::string_view text, T& out) {
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return ec == std::errc{} && ptr == text.data() + text.size();
+}
+
+
+#endif //MOVIERECOMMENDER_CSV_H
\ No newline at end of file
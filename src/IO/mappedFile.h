@@ -0,0 +1,31 @@
+#ifndef MOVIERECOMMENDER_MAPPEDFILE_H
+#define MOVIERECOMMENDER_MAPPEDFILE_H
+#include <cstddef>
+#include <span>
+#include <string>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the
+// object; throws std::runtime_error if the file cannot be opened or mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const std::byte* data() const { return base; }
+    [[nodiscard]] std::size_t size() const { return length; }
+    [[nodiscard]] std::span<const std::byte> bytes() const { return {base, length}; }
+
+private:
+    const std::byte* base = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+
+#endif //MOVIERECOMMENDER_MAPPEDFILE_H
\ No newline at end of file
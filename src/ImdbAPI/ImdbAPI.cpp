@@ -1,26 +1,57 @@
 #include "ImdbAPI.h"
+#include <algorithm>
+#include <optional>
 #include <stdexcept>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 
-TmdbAPI::TmdbAPI(std::string apiKey)
+TmdbAPI::TmdbAPI(std::string apiKey, TmdbApiOptions options)
     : apiKey_(std::move(apiKey)),
-      baseUrl_("https://api.themoviedb.org/3") {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+      baseUrl_(std::move(options.baseUrl)),
+      maxConcurrent_(options.maxConcurrentRequests),
+      curlPool_(options.reuseConnections) {
+    if (!options.cacheDir.empty()) {
+        cache_ = std::make_unique<HttpDiskCache>(options.cacheDir, options.cacheTtl, options.cacheMode);
+    }
 }
 
-TmdbAPI::~TmdbAPI() {
-    curl_global_cleanup();
-}
+TmdbAPI::~TmdbAPI() = default;
 
 Movie TmdbAPI::fetchMovieById(const int tmdbId) const {
-    const std::string url = baseUrl_ +
+    return parseMovieDetails(getJson(movieUrl(tmdbId)), tmdbId);
+}
+
+// All details requests go out together through getAll, so a batch costs
+// about one round trip per maxConcurrent_ ids instead of one per id.
+std::vector<Movie> TmdbAPI::fetchMoviesByIds(const std::span<const int> tmdbIds) const {
+    std::vector<std::string> urls;
+    urls.reserve(tmdbIds.size());
+    for (const int id : tmdbIds) urls.push_back(movieUrl(id));
+
+    std::vector<Movie> movies(tmdbIds.size());
+    std::vector<std::string> errors(tmdbIds.size());
+    getAll(urls, [&](const std::size_t i, const HttpResponse& response) {
+        try {
+            movies[i] = parseMovieDetails(toJson(response), tmdbIds[i]);
+        } catch (const std::exception& e) {
+            errors[i] = e.what();
+        }
+    });
+
+    for (const auto& error : errors) {
+        if (!error.empty()) throw std::runtime_error(error);
+    }
+    return movies;
+}
+
+std::string TmdbAPI::movieUrl(const int tmdbId) const {
+    return baseUrl_ +
         "/movie/" + std::to_string(tmdbId) +
         "?api_key=" + apiKey_ +
         "&language=en-US";
+}
 
-    nlohmann::json j = getJson(url);
-
+Movie TmdbAPI::parseMovieDetails(const nlohmann::json& j, const int tmdbId) {
     Movie m;
     m.tmdbId = j.value("id", tmdbId);
     m.name   = j.value("title", "");
@@ -46,6 +77,9 @@ Movie TmdbAPI::fetchMovieById(const int tmdbId) const {
     return m;
 }
 
+// Pages are requested concurrently and parsed as they arrive, then merged in
+// page order. That keeps the serial semantics: stop at the first page without
+// results, fail on the first failed page actually needed, and cut at poolSize.
 std::vector<Movie> TmdbAPI::fetchPopularMovies(const int poolSize) const {
     std::vector<Movie> result;
     if (poolSize <= 0) return result;
@@ -53,62 +87,94 @@ std::vector<Movie> TmdbAPI::fetchPopularMovies(const int poolSize) const {
     constexpr int perPage = 20;
     const int maxPages = (poolSize + perPage - 1) / perPage;
 
-    const auto genreMap = fetchGenreMap();
-
+    const auto& genreMap = this->genreMap();
 
+    std::vector<std::string> urls;
+    urls.reserve(maxPages);
     for (int page = 1; page <= maxPages; ++page) {
-        const std::string url = baseUrl_ +
+        urls.push_back(baseUrl_ +
             "/movie/popular" +
             "?api_key=" + apiKey_ +
             "&language=en-US" +
-            "&page=" + std::to_string(page);
+            "&page=" + std::to_string(page));
+    }
 
-        nlohmann::json j = getJson(url);
-        if (!j.contains("results") || !j["results"].is_array()) break;
+    struct PageResult {
+        std::vector<Movie> movies;
+        bool hasResults = false;
+        std::string error;
+    };
+    std::vector<PageResult> pages(maxPages);
+    getAll(urls, [&](const std::size_t i, const HttpResponse& response) {
+        try {
+            const nlohmann::json j = toJson(response);
+            if (!j.contains("results") || !j["results"].is_array()) return;
+            pages[i].hasResults = true;
+            parsePopularPage(j, genreMap, pages[i].movies);
+        } catch (const std::exception& e) {
+            pages[i].error = e.what();
+        }
+    });
 
-        for (const auto& r : j["results"]) {
-            constexpr double MIN_POPULARITY = 10.0;
-            constexpr int MIN_VOTE_COUNT = 300;
+    for (auto& page : pages) {
+        if (!page.error.empty()) throw std::runtime_error(page.error);
+        if (!page.hasResults) break;
+        for (auto& m : page.movies) {
             if (static_cast<int>(result.size()) >= poolSize) break;
+            result.push_back(std::move(m));
+        }
+        if (static_cast<int>(result.size()) >= poolSize) break;
+    }
 
-            const int    voteCount  = r.value("vote_count", 0);
-            if (const double popularity = r.value("popularity", 0.0); voteCount < MIN_VOTE_COUNT || popularity < MIN_POPULARITY) {
-                continue;
-            }
+    return result;
+}
 
-            Movie m;
-            m.tmdbId = r.value("id", 0);
-            m.name   = r.value("title", "");
-            if (m.tmdbId == 0 || m.name.empty()) {
-                continue;
-            }
+Movie TmdbAPI::parseMovieSummary(const nlohmann::json& r, const std::unordered_map<int, std::string>& genreMap) {
+    Movie m;
+    m.tmdbId = r.value("id", 0);
+    m.name   = r.value("title", "");
 
-            if (r.contains("vote_average") && r["vote_average"].is_number()) {
-                m.rating = r["vote_average"].get<double>();
-            }
+    if (r.contains("vote_average") && r["vote_average"].is_number()) {
+        m.rating = r["vote_average"].get<double>();
+    }
 
-            if (r.contains("release_date") && r["release_date"].is_string()) {
-                if (const std::string date = r["release_date"].get<std::string>(); date.size() >= 4) {
-                    m.year = std::stoi(date.substr(0, 4));
-                }
-            }
+    if (r.contains("release_date") && r["release_date"].is_string()) {
+        if (const std::string date = r["release_date"].get<std::string>(); date.size() >= 4) {
+            m.year = std::stoi(date.substr(0, 4));
+        }
+    }
 
-            if (r.contains("genre_ids") && r["genre_ids"].is_array()) {
-                for (const auto& gidJson : r["genre_ids"]) {
-                    const int gid = gidJson.get<int>();
-                    if (auto it = genreMap.find(gid); it != genreMap.end()) {
-                        m.genres.push_back(it->second);
-                    }
-                }
+    if (r.contains("genre_ids") && r["genre_ids"].is_array()) {
+        for (const auto& gidJson : r["genre_ids"]) {
+            const int gid = gidJson.get<int>();
+            if (auto it = genreMap.find(gid); it != genreMap.end()) {
+                m.genres.push_back(it->second);
             }
+        }
+    }
 
-            result.push_back(std::move(m));
+    return m;
+}
+
+void TmdbAPI::parsePopularPage(const nlohmann::json& page,
+                               const std::unordered_map<int, std::string>& genreMap,
+                               std::vector<Movie>& out) {
+    for (const auto& r : page["results"]) {
+        constexpr double MIN_POPULARITY = 10.0;
+        constexpr int MIN_VOTE_COUNT = 300;
+
+        const int    voteCount  = r.value("vote_count", 0);
+        if (const double popularity = r.value("popularity", 0.0); voteCount < MIN_VOTE_COUNT || popularity < MIN_POPULARITY) {
+            continue;
         }
 
-        if (static_cast<int>(result.size()) >= poolSize) break;
-    }
+        Movie m = parseMovieSummary(r, genreMap);
+        if (m.tmdbId == 0 || m.name.empty()) {
+            continue;
+        }
 
-    return result;
+        out.push_back(std::move(m));
+    }
 }
 
 std::vector<Movie> TmdbAPI::searchMoviesByTitle(const std::string& query,
@@ -127,27 +193,14 @@ std::vector<Movie> TmdbAPI::searchMoviesByTitle(const std::string& query,
     nlohmann::json j = getJson(url);
     if (!j.contains("results") || !j["results"].is_array()) return out;
 
+    const auto& genreMap = this->genreMap();
     for (const auto& r : j["results"]) {
         if (static_cast<int>(out.size()) >= limit) break;
+        if (!r.contains("release_date") || !r["release_date"].is_string()) continue;
 
-        Movie m;
-        m.tmdbId = r.value("id", 0);
-        m.name   = r.value("title", "");
+        Movie m = parseMovieSummary(r, genreMap);
         if (m.tmdbId == 0 || m.name.empty()) continue;
 
-        if (r.contains("vote_average") && r["vote_average"].is_number()) {
-            m.rating = r["vote_average"].get<double>();
-        }
-
-        if (r.contains("release_date") && r["release_date"].is_string()) {
-            const std::string date = r["release_date"].get<std::string>();
-            if (date.size() >= 4) {
-                m.year = std::stoi(date.substr(0, 4));
-            }
-        } else {
-            continue;
-        }
-
         out.push_back(std::move(m));
     }
 
@@ -164,44 +217,156 @@ size_t TmdbAPI::writeCallback(const char* ptr,
     return count;
 }
 
-nlohmann::json TmdbAPI::getJson(const std::string& url) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("curl_easy_init failed");
+std::optional<HttpCacheStats> TmdbAPI::cacheStats() const {
+    if (!cache_) return std::nullopt;
+    return cache_->stats();
+}
+
+// A cache hit as a 200 response. In offline mode a miss becomes a failed
+// response, so nothing reaches the network.
+std::optional<TmdbAPI::HttpResponse> TmdbAPI::cached(const std::string& url) const {
+    if (!cache_) return std::nullopt;
+    if (auto body = cache_->lookup(url)) {
+        return HttpResponse{200, std::move(*body), {}};
+    }
+    if (cache_->mode() == HttpCacheMode::OfflineOnly) {
+        return HttpResponse{0, {}, "not in the response cache (offline mode): " + HttpDiskCache::normalizeUrl(url)};
     }
+    return std::nullopt;
+}
 
-    std::string response;
+void TmdbAPI::remember(const std::string& url, const HttpResponse& response) const {
+    if (cache_ && response.error.empty() && response.status >= 200 && response.status < 300) {
+        cache_->store(url, response.body);
+    }
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &TmdbAPI::writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+nlohmann::json TmdbAPI::getJson(const std::string& url) const {
+    if (auto hit = cached(url)) return toJson(*hit);
 
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    HttpResponse response;
+    {
+        const auto lease = curlPool_.acquire();
+        CURL* curl = lease.get();
 
-    const CURLcode res = curl_easy_perform(curl);
-    long httpCode = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-    curl_easy_cleanup(curl);
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &TmdbAPI::writeCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
 
-    if (res != CURLE_OK) {
-        throw std::runtime_error(
-            std::string("curl_easy_perform failed: ") +
-            curl_easy_strerror(res));
+        if (const CURLcode res = curl_easy_perform(curl); res != CURLE_OK) {
+            response.error = curl_easy_strerror(res);
+        }
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
     }
+    remember(url, response);
+    return toJson(response);
+}
 
-    if (httpCode < 200 || httpCode >= 300) {
+// Answers what it can from the cache, then runs the remaining transfers on
+// one curl_multi handle with at most maxConcurrent_ in flight, using handles
+// from the pool. onDone runs on this thread as each transfer finishes, in
+// completion order.
+void TmdbAPI::getAll(const std::vector<std::string>& urls,
+                     const std::function<void(std::size_t, const HttpResponse&)>& onDone) const {
+    std::vector<std::size_t> pending;
+    for (std::size_t i = 0; i < urls.size(); ++i) {
+        if (const auto hit = cached(urls[i])) {
+            onDone(i, *hit);
+        } else {
+            pending.push_back(i);
+        }
+    }
+    if (pending.empty()) return;
+
+    struct Transfer {
+        std::optional<CurlHandlePool::Lease> lease;
+        HttpResponse response;
+        std::size_t index = 0;
+    };
+
+    CURLM* multi = curl_multi_init();
+    if (!multi) {
+        throw std::runtime_error("curl_multi_init failed");
+    }
+    std::vector<Transfer> slots(std::min(pending.size(), static_cast<std::size_t>(std::max(1, maxConcurrent_))));
+
+    struct Cleanup {
+        CURLM* multi;
+        std::vector<Transfer>& slots;
+        ~Cleanup() {
+            for (auto& t : slots) {
+                if (t.lease) curl_multi_remove_handle(multi, t.lease->get());
+                t.lease.reset();
+            }
+            curl_multi_cleanup(multi);
+        }
+    } cleanup{multi, slots};
+
+    std::size_t next = 0;
+    std::size_t active = 0;
+    auto start = [&](Transfer& t) {
+        t.lease.emplace(curlPool_.acquire());
+        t.response = {};
+        t.index = pending[next++];
+        CURL* curl = t.lease->get();
+        curl_easy_setopt(curl, CURLOPT_URL, urls[t.index].c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &TmdbAPI::writeCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t.response.body);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, &t);
+        curl_multi_add_handle(multi, curl);
+        ++active;
+    };
+    for (auto& t : slots) start(t);
+
+    while (active > 0) {
+        int running = 0;
+        if (const CURLMcode mc = curl_multi_perform(multi, &running); mc != CURLM_OK) {
+            throw std::runtime_error(std::string("curl_multi_perform failed: ") + curl_multi_strerror(mc));
+        }
+
+        int queued = 0;
+        while (const CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            CURL* curl = msg->easy_handle;
+            Transfer* t = nullptr;
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, &t);
+            if (msg->data.result != CURLE_OK) {
+                t->response.error = curl_easy_strerror(msg->data.result);
+            }
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &t->response.status);
+            curl_multi_remove_handle(multi, curl);
+            t->lease.reset();
+            --active;
+
+            remember(urls[t->index], t->response);
+            onDone(t->index, t->response);
+            if (next < pending.size()) start(*t);
+        }
+
+        if (active > 0) {
+            curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+        }
+    }
+}
+
+nlohmann::json TmdbAPI::toJson(const HttpResponse& response) {
+    if (!response.error.empty()) {
+        throw std::runtime_error("curl_easy_perform failed: " + response.error);
+    }
+
+    if (response.status < 200 || response.status >= 300) {
         throw std::runtime_error(
-            "TMDB HTTP error " + std::to_string(httpCode) +
-            " | body: " + response);
+            "TMDB HTTP error " + std::to_string(response.status) +
+            " | body: " + response.body);
     }
 
     try {
-        return nlohmann::json::parse(response);
+        return nlohmann::json::parse(response.body);
     } catch (const std::exception& e) {
         throw std::runtime_error(
             std::string("JSON parse failed: ") + e.what() +
-            " | body: " + response);
+            " | body: " + response.body);
     }
 }
 
@@ -225,14 +390,12 @@ std::string TmdbAPI::urlEncode(const std::string& s) {
     return out;
 }
 
-std::unordered_map<int, std::string> TmdbAPI::fetchGenreMap() const {
-    const std::string url = baseUrl_ +
-        "/genre/movie/list" +
-        "?api_key=" + apiKey_ +
-        "&language=en-US";
-
-    nlohmann::json j = getJson(url);
+const std::unordered_map<int, std::string>& TmdbAPI::genreMap() const {
+    std::call_once(genreMapOnce_, [this] { genreMap_ = fetchGenreMap(); });
+    return genreMap_;
+}
 
+std::unordered_map<int, std::string> TmdbAPI::parseGenreList(const nlohmann::json& j) {
     std::unordered_map<int, std::string> map;
     if (j.contains("genres") && j["genres"].is_array()) {
         for (const auto& g : j["genres"]) {
@@ -244,3 +407,12 @@ std::unordered_map<int, std::string> TmdbAPI::fetchGenreMap() const {
     }
     return map;
 }
+
+std::unordered_map<int, std::string> TmdbAPI::fetchGenreMap() const {
+    const std::string url = baseUrl_ +
+        "/genre/movie/list" +
+        "?api_key=" + apiKey_ +
+        "&language=en-US";
+
+    return parseGenreList(getJson(url));
+}
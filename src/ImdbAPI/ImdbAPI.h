@@ -1,28 +1,92 @@
 #ifndef MOVIERECOMMENDER_IMDBAPI_H
 #define MOVIERECOMMENDER_IMDBAPI_H
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <stdexcept>
 #include <nlohmann/json.hpp>
 #include "../MoviesUtil/Movie.h"
+#include "./curlPool.h"
+#include "./httpCache.h"
 
+struct TmdbApiOptions {
+    // Point at a local stand-in server for tests and benchmarks.
+    std::string baseUrl = "https://api.themoviedb.org/3";
+    // Keep pooled handles and shared connections between requests; off
+    // opens a new connection per request.
+    bool reuseConnections = true;
+    // Requests kept in flight at once by fetchPopularMovies and
+    // fetchMoviesByIds.
+    int maxConcurrentRequests = 8;
+    // Directory for the on-disk response cache; empty disables it.
+    std::string cacheDir;
+    std::chrono::seconds cacheTtl = std::chrono::hours(24);
+    HttpCacheMode cacheMode = HttpCacheMode::Normal;
+};
+
+// Safe to call from several threads at once: requests take handles from a
+// thread-safe pool, and each batch runs on its own curl_multi handle.
 class TmdbAPI {
 public:
-    explicit TmdbAPI(std::string apiKey);
+    explicit TmdbAPI(std::string apiKey, TmdbApiOptions options = {});
     ~TmdbAPI();
 
     [[nodiscard]] Movie fetchMovieById(int tmdbId) const;
 
+    // Details for every id, in the same order, with up to
+    // maxConcurrentRequests in flight. Throws the first failure in id order,
+    // after all transfers have finished.
+    [[nodiscard]] std::vector<Movie> fetchMoviesByIds(std::span<const int> tmdbIds) const;
+
     [[nodiscard]] std::vector<Movie> fetchPopularMovies(int poolSize) const;
 
+    // Results carry their genres, resolved from the genre table, so they are
+    // complete Movies without a fetchMovieById per result.
     [[nodiscard]] std::vector<Movie> searchMoviesByTitle(const std::string& query, int limit = 5) const;
 
+    // TMDb genre id -> name, requested once per instance. The request goes
+    // through the response cache, so its TTL and mode apply to it too.
+    [[nodiscard]] const std::unordered_map<int, std::string>& genreMap() const;
+
+    [[nodiscard]] std::size_t curlHandlesCreated() const { return curlPool_.handlesCreated(); }
+    [[nodiscard]] std::optional<HttpCacheStats> cacheStats() const;
+
 private:
+    struct HttpResponse {
+        long status = 0;
+        std::string body;
+        std::string error;
+    };
+
+    CurlGlobal curlGlobal_;
     std::string apiKey_;
     std::string baseUrl_;
+    int maxConcurrent_;
+    mutable CurlHandlePool curlPool_;
+    std::unique_ptr<HttpDiskCache> cache_;
+    mutable std::once_flag genreMapOnce_;
+    mutable std::unordered_map<int, std::string> genreMap_;
 
     static size_t writeCallback(const char* ptr, size_t size, size_t nmemb, void* userdata);
-    static nlohmann::json getJson(const std::string& url);
+    static nlohmann::json toJson(const HttpResponse& response);
+    [[nodiscard]] std::optional<HttpResponse> cached(const std::string& url) const;
+    void remember(const std::string& url, const HttpResponse& response) const;
+    [[nodiscard]] std::string movieUrl(int tmdbId) const;
+    [[nodiscard]] nlohmann::json getJson(const std::string& url) const;
+    void getAll(const std::vector<std::string>& urls,
+                const std::function<void(std::size_t, const HttpResponse&)>& onDone) const;
+    static Movie parseMovieDetails(const nlohmann::json& j, int tmdbId);
+    static Movie parseMovieSummary(const nlohmann::json& r, const std::unordered_map<int, std::string>& genreMap);
+    static void parsePopularPage(const nlohmann::json& page,
+                                 const std::unordered_map<int, std::string>& genreMap,
+                                 std::vector<Movie>& out);
+    static std::unordered_map<int, std::string> parseGenreList(const nlohmann::json& j);
     static std::string urlEncode(const std::string& s);
 
     [[nodiscard]] std::unordered_map<int, std::string> fetchGenreMap() const;
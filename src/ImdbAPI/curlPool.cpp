@@ -0,0 +1,85 @@
+#include "curlPool.h"
+#include <stdexcept>
+
+CurlGlobal::CurlGlobal() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+CurlGlobal::~CurlGlobal() {
+    curl_global_cleanup();
+}
+
+CurlHandlePool::CurlHandlePool(const bool reuse, const std::size_t maxIdle)
+    : reuse(reuse),
+      maxIdle(maxIdle) {
+    if (!reuse) return;
+
+    share = curl_share_init();
+    if (!share) {
+        throw std::runtime_error("curl_share_init failed");
+    }
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC,
+                      +[](CURL*, const curl_lock_data data, curl_lock_access, void* user) {
+                          static_cast<std::mutex*>(user)[data].lock();
+                      });
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC,
+                      +[](CURL*, const curl_lock_data data, void* user) {
+                          static_cast<std::mutex*>(user)[data].unlock();
+                      });
+    curl_share_setopt(share, CURLSHOPT_USERDATA, static_cast<void*>(shareLocks));
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    // Not CURL_LOCK_DATA_CONNECT: libcurl does not support a shared
+    // connection cache between threads. Each pooled handle keeps its own
+    // live connections instead.
+}
+
+CurlHandlePool::~CurlHandlePool() {
+    for (CURL* handle : idle) curl_easy_cleanup(handle);
+    if (share) curl_share_cleanup(share);
+}
+
+CurlHandlePool::Lease CurlHandlePool::acquire() {
+    CURL* handle = nullptr;
+    if (reuse) {
+        const std::lock_guard lock(idleMutex);
+        if (!idle.empty()) {
+            handle = idle.back();
+            idle.pop_back();
+        }
+    }
+
+    if (handle) {
+        // Clears per-request options but keeps the handle's live connections.
+        curl_easy_reset(handle);
+    } else {
+        handle = curl_easy_init();
+        if (!handle) {
+            throw std::runtime_error("curl_easy_init failed");
+        }
+        ++created;
+    }
+    applyDefaults(handle);
+    return {*this, handle};
+}
+
+void CurlHandlePool::release(CURL* handle) {
+    if (reuse) {
+        const std::lock_guard lock(idleMutex);
+        if (idle.size() < maxIdle) {
+            idle.push_back(handle);
+            return;
+        }
+    }
+    curl_easy_cleanup(handle);
+}
+
+void CurlHandlePool::applyDefaults(CURL* handle) const {
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    if (reuse) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, share);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef MOVIERECOMMENDER_CURLPOOL_H
+#define MOVIERECOMMENDER_CURLPOOL_H
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <curl/curl.h>
+
+// curl_global_init/cleanup for the lifetime of the object. Declare it before
+// any member that owns curl handles so those are cleaned up first.
+struct CurlGlobal {
+    CurlGlobal();
+    ~CurlGlobal();
+
+    CurlGlobal(const CurlGlobal&) = delete;
+    CurlGlobal& operator=(const CurlGlobal&) = delete;
+};
+
+// Thread-safe pool of easy handles. A returned handle keeps its open
+// connections, so back-to-back requests to the same host reuse a keep-alive
+// connection instead of a new TCP + TLS handshake, and every handle shares
+// one DNS and TLS session cache (CURLSH), so a new connection can resume a
+// session. Connections themselves are not shared: libcurl does not support
+// that across threads.
+// With reuse off, every lease gets a fresh handle that is cleaned up on
+// release, which is what TmdbAPI used to do per request.
+class CurlHandlePool {
+public:
+    class Lease {
+    public:
+        Lease(CurlHandlePool& pool, CURL* handle) : pool(&pool), handle(handle) {}
+        ~Lease() { if (handle) pool->release(handle); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& other) noexcept : pool(other.pool), handle(other.handle) { other.handle = nullptr; }
+        Lease& operator=(Lease&&) = delete;
+
+        [[nodiscard]] CURL* get() const { return handle; }
+
+    private:
+        CurlHandlePool* pool;
+        CURL* handle;
+    };
+
+    explicit CurlHandlePool(bool reuse = true, std::size_t maxIdle = 16);
+    ~CurlHandlePool();
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+    // A handle with the pool's defaults applied (shared cache, keep-alive);
+    // callers set the URL and callbacks. Throws if no handle can be created.
+    Lease acquire();
+
+    [[nodiscard]] bool reusesConnections() const { return reuse; }
+    [[nodiscard]] std::size_t handlesCreated() const { return created.load(); }
+
+private:
+    void release(CURL* handle);
+    void applyDefaults(CURL* handle) const;
+
+    bool reuse;
+    std::size_t maxIdle;
+    CURLSH* share = nullptr;
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+    std::mutex idleMutex;
+    std::vector<CURL*> idle;
+    std::atomic<std::size_t> created{0};
+};
+
+
+#endif //MOVIERECOMMENDER_CURLPOOL_H
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "httpCache.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef MOVIERECOMMENDER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+    constexpr char ENTRY_MAGIC[8] = {'M', 'R', 'H', 'T', 'T', 'P', '1', '\0'};
+    constexpr std::uint32_t FLAG_ZLIB = 1;
+    // bodyLength comes from the file, so it is checked before anything is
+    // allocated for it: deflate never expands by more than 1032:1, and no
+    // TMDb response comes near the cap.
+    constexpr std::uint64_t MAX_BODY_LENGTH = std::uint64_t{64} << 20;
+    constexpr std::uint64_t MAX_DEFLATE_RATIO = 1032;
+
+    struct EntryHeader {
+        char magic[8];
+        std::uint32_t flags;
+        std::uint32_t urlLength;
+        std::int64_t storedAt;
+        std::uint64_t bodyLength;
+        std::uint64_t payloadLength;
+    };
+    static_assert(sizeof(EntryHeader) == 40);
+
+    std::uint64_t fnv1a(const std::string& s) {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        for (const unsigned char c : s) {
+            h ^= c;
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    std::int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::string compress(const std::string& body, [[maybe_unused]] std::uint32_t& flags) {
+#ifdef MOVIERECOMMENDER_HAVE_ZLIB
+        uLongf size = compressBound(static_cast<uLong>(body.size()));
+        std::string out(size, '\0');
+        if (compress2(reinterpret_cast<Bytef*>(out.data()), &size,
+                      reinterpret_cast<const Bytef*>(body.data()), static_cast<uLong>(body.size()),
+                      Z_BEST_SPEED) == Z_OK) {
+            out.resize(size);
+            flags |= FLAG_ZLIB;
+            return out;
+        }
+#endif
+        return body;
+    }
+
+    std::optional<std::string> decompress(const std::string& payload, const EntryHeader& h) {
+        if ((h.flags & FLAG_ZLIB) == 0) {
+            return payload.size() == h.bodyLength ? std::optional(payload) : std::nullopt;
+        }
+#ifdef MOVIERECOMMENDER_HAVE_ZLIB
+        if (h.bodyLength > MAX_BODY_LENGTH || h.bodyLength > payload.size() * MAX_DEFLATE_RATIO) {
+            return std::nullopt;
+        }
+        std::string body(h.bodyLength, '\0');
+        uLongf size = static_cast<uLongf>(h.bodyLength);
+        if (uncompress(reinterpret_cast<Bytef*>(body.data()), &size,
+                       reinterpret_cast<const Bytef*>(payload.data()), static_cast<uLong>(payload.size())) == Z_OK
+            && size == h.bodyLength) {
+            return body;
+        }
+#endif
+        return std::nullopt;
+    }
+}
+
+HttpDiskCache::HttpDiskCache(std::string dir, const std::chrono::seconds ttl, const HttpCacheMode mode)
+    : dir(std::move(dir)),
+      ttl(ttl),
+      cacheMode(mode) {
+    std::filesystem::create_directories(this->dir);
+}
+
+std::string HttpDiskCache::normalizeUrl(const std::string& url) {
+    const auto q = url.find('?');
+    if (q == std::string::npos) return url;
+
+    std::vector<std::string> params;
+    std::stringstream query(url.substr(q + 1));
+    for (std::string param; std::getline(query, param, '&');) {
+        if (!param.empty() && param.rfind("api_key=", 0) != 0) params.push_back(param);
+    }
+    std::ranges::sort(params);
+
+    std::string out = url.substr(0, q);
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        out += (i == 0 ? '?' : '&');
+        out += params[i];
+    }
+    return out;
+}
+
+std::string HttpDiskCache::pathFor(const std::string& key) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(fnv1a(key)));
+    return dir + "/" + name + ".entry";
+}
+
+std::optional<std::string> HttpDiskCache::lookup(const std::string& url) {
+    if (cacheMode == HttpCacheMode::Refresh) {
+        ++misses;
+        return std::nullopt;
+    }
+
+    const std::string key = normalizeUrl(url);
+    const std::string path = pathFor(key);
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(path, ec);
+    std::ifstream in(path, std::ios::binary);
+    EntryHeader h{};
+    std::string storedUrl;
+    std::string payload;
+    if (!ec && in.read(reinterpret_cast<char*>(&h), sizeof(h))
+        && std::memcmp(h.magic, ENTRY_MAGIC, sizeof(h.magic)) == 0
+        && h.urlLength == key.size() && h.payloadLength <= fileSize
+        && sizeof(h) + h.urlLength + h.payloadLength == fileSize) {
+        storedUrl.resize(h.urlLength);
+        payload.resize(h.payloadLength);
+        in.read(storedUrl.data(), static_cast<std::streamsize>(storedUrl.size()));
+        in.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+    }
+    if (ec || !in || storedUrl != key) {
+        ++misses;
+        return std::nullopt;
+    }
+
+    if (cacheMode == HttpCacheMode::Normal && nowSeconds() - h.storedAt > ttl.count()) {
+        ++expired;
+        ++misses;
+        return std::nullopt;
+    }
+
+    auto body = decompress(payload, h);
+    ++(body ? hits : misses);
+    return body;
+}
+
+void HttpDiskCache::store(const std::string& url, const std::string& body) {
+    if (cacheMode == HttpCacheMode::OfflineOnly) return;
+
+    const std::string key = normalizeUrl(url);
+    EntryHeader h{};
+    std::memcpy(h.magic, ENTRY_MAGIC, sizeof(h.magic));
+    const std::string payload = compress(body, h.flags);
+    h.urlLength = static_cast<std::uint32_t>(key.size());
+    h.storedAt = nowSeconds();
+    h.bodyLength = body.size();
+    h.payloadLength = payload.size();
+
+    const std::string path = pathFor(key);
+    std::ostringstream tmpName;
+    tmpName << path << ".tmp" << std::this_thread::get_id();
+    const std::string tmpPath = tmpName.str();
+    bool written;
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(key.data(), static_cast<std::streamsize>(key.size()));
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        out.close();
+        written = static_cast<bool>(out);
+    }
+
+    // A cache that cannot be written is only slower, not an error.
+    std::error_code ec;
+    if (written) std::filesystem::rename(tmpPath, path, ec);
+    if (!written || ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return;
+    }
+    ++stores;
+    bytesStored += sizeof(h) + key.size() + payload.size();
+}
+
+HttpCacheStats HttpDiskCache::stats() const {
+    HttpCacheStats s;
+    s.hits = hits;
+    s.misses = misses;
+    s.expired = expired;
+    s.stores = stores;
+    s.bytesStored = bytesStored;
+    return s;
+}
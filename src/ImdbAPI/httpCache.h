@@ -0,0 +1,63 @@
+#ifndef MOVIERECOMMENDER_HTTPCACHE_H
+#define MOVIERECOMMENDER_HTTPCACHE_H
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+enum class HttpCacheMode {
+    Normal,       // serve fresh entries, fetch and store the rest
+    OfflineOnly,  // serve any entry, however old; never touch the network
+    Refresh,      // always fetch, then overwrite the entry
+};
+
+struct HttpCacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t expired = 0;
+    std::size_t stores = 0;
+    std::size_t bytesStored = 0;
+
+    [[nodiscard]] double hitRate() const {
+        const std::size_t total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+// Disk cache of HTTP response bodies, one file per request under `dir`,
+// named by a hash of the normalized URL: query parameters sorted, api_key
+// dropped, so the same request hits whatever key it was made with. Each
+// entry records its URL (checked on read, so a hash collision is a miss),
+// the time it was stored and the body, zlib-compressed when the build has
+// zlib. Files are written under a temporary name and renamed into place, so
+// concurrent readers never see half an entry.
+class HttpDiskCache {
+public:
+    HttpDiskCache(std::string dir, std::chrono::seconds ttl, HttpCacheMode mode = HttpCacheMode::Normal);
+
+    // The cached body for url, if the mode allows serving it. Counts a hit or
+    // a miss (and an expired entry when it is too old).
+    std::optional<std::string> lookup(const std::string& url);
+    void store(const std::string& url, const std::string& body);
+
+    [[nodiscard]] HttpCacheMode mode() const { return cacheMode; }
+    [[nodiscard]] HttpCacheStats stats() const;
+
+    static std::string normalizeUrl(const std::string& url);
+
+private:
+    [[nodiscard]] std::string pathFor(const std::string& key) const;
+
+    std::string dir;
+    std::chrono::seconds ttl;
+    HttpCacheMode cacheMode;
+    std::atomic<std::size_t> hits{0};
+    std::atomic<std::size_t> misses{0};
+    std::atomic<std::size_t> expired{0};
+    std::atomic<std::size_t> stores{0};
+    std::atomic<std::size_t> bytesStored{0};
+};
+
+
+#endif //MOVIERECOMMENDER_HTTPCACHE_H
\ No newline at end of file
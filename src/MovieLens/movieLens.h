@@ -0,0 +1,352 @@
+#ifndef MOVIERECOMMENDER_MOVIELENS_H
+#define MOVIERECOMMENDER_MOVIELENS_H
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../IO/csv.h"
+#include "../IO/mappedFile.h"
+#include "../Collaborative/ratingMatrix.h"
+#include "../MoviesUtil/Movie.h"
+#include "../Parallel/threadPool.h"
+
+// Offline loader for a MovieLens dump (e.g. ml-25m/):
+//   movies.csv   movieId,title,genres       title ends in "(year)", genres are '|'-separated
+//   links.csv    movieId,imdbId,tmdbId      optional; supplies Movie::tmdbId
+//   ratings.csv  userId,movieId,rating,ts   optional; averaged into Movie::rating
+// Each file is memory-mapped and cut into line-aligned chunks that are parsed
+// in parallel, then merged in file order.
+
+struct MovieLensFileStats {
+    std::size_t rows = 0;
+    double ms = 0.0;
+
+    [[nodiscard]] double rowsPerSecond() const { return ms > 0.0 ? rows / (ms / 1000.0) : 0.0; }
+};
+
+struct MovieLensStats {
+    MovieLensFileStats movies;
+    MovieLensFileStats links;
+    MovieLensFileStats ratings;
+    std::size_t skippedWithoutTmdbId = 0;
+};
+
+struct MovieLensData {
+    std::vector<Movie> movies;
+    std::vector<int> movieLensIds;
+    MovieLensStats stats;
+};
+
+namespace movielens_detail {
+    struct MovieRow {
+        int movieId;
+        Movie movie;
+    };
+
+    // "Heat (1995)" -> name "Heat", year 1995. Titles without a trailing
+    // four-digit year are kept whole with year 0.
+    inline void splitTitleYear(std::string_view title, Movie& m) {
+        while (!title.empty() && (title.back() == ' ' || title.back() == '\r')) title.remove_suffix(1);
+
+        m.year = 0;
+        if (title.size() >= 6 && title.back() == ')' && title[title.size() - 6] == '(') {
+            int year = 0;
+            if (parseNumber(title.substr(title.size() - 5, 4), year)) {
+                m.year = year;
+                title.remove_suffix(6);
+                while (!title.empty() && title.back() == ' ') title.remove_suffix(1);
+            }
+        }
+        m.name.assign(title);
+    }
+
+    inline void splitGenres(const std::string_view genres, Movie& m) {
+        if (genres == "(no genres listed)") return;
+        std::size_t begin = 0;
+        while (begin < genres.size()) {
+            std::size_t end = genres.find('|', begin);
+            if (end == std::string_view::npos) end = genres.size();
+            if (end > begin) m.genres.emplace_back(genres.substr(begin, end - begin));
+            begin = end + 1;
+        }
+    }
+
+    // Parses every chunk with parseChunk(chunk, out) on the pool and returns
+    // the per-chunk outputs in file order.
+    template<class Out, class ParseChunk>
+    std::vector<Out> parseChunks(const MappedFile& file, ThreadPool& pool, ParseChunk&& parseChunk) {
+        const std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+        const auto chunks = splitLines(skipFirstLine(text), static_cast<std::size_t>(pool.size()) * 4);
+        std::vector<Out> outputs(chunks.size());
+        pool.parallelFor(static_cast<int>(chunks.size()), [&](const int begin, const int end) {
+            for (int c = begin; c < end; ++c) parseChunk(chunks[c], outputs[c]);
+        }, 1);
+        return outputs;
+    }
+
+    inline double elapsedMs(const std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Calls fn(userField, movieId, rating) for each well-formed ratings.csv
+    // line. movieId and rating are read in place with from_chars; the user
+    // field is left as text for callers that need it. Returns the line count.
+    template<class Fn>
+    std::size_t forEachRating(const std::string_view chunk, Fn&& fn) {
+        const char* p = chunk.data();
+        const char* const end = p + chunk.size();
+        std::size_t rows = 0;
+
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!lineEnd) lineEnd = end;
+
+            const char* q = static_cast<const char*>(std::memchr(p, ',', lineEnd - p));
+            int movieId = 0;
+            double rating = 0.0;
+            if (q) {
+                const auto id = std::from_chars(q + 1, lineEnd, movieId);
+                if (id.ec == std::errc{} && id.ptr < lineEnd && *id.ptr == ',') {
+                    const auto r = std::from_chars(id.ptr + 1, lineEnd, rating);
+                    if (r.ec == std::errc{}) {
+                        ++rows;
+                        fn(std::string_view(p, q - p), movieId, rating);
+                    }
+                }
+            }
+            p = lineEnd + 1;
+        }
+        return rows;
+    }
+
+    inline int denseIndex(const std::vector<int>& denseOf, const int movieId) {
+        return movieId >= 0 && static_cast<std::size_t>(movieId) < denseOf.size() ? denseOf[movieId] : -1;
+    }
+}
+
+struct RatingTotals {
+    std::vector<double> sum;
+    std::vector<std::uint32_t> count;
+    std::size_t rows = 0;
+};
+
+// Sums ratings.csv per movie. denseOf maps a MovieLens movieId to a dense
+// index in [0, denseCount), or -1 for movies that are not kept. The file is
+// cut into one line-aligned chunk per worker; each worker adds into its own
+// (sum, count) arrays, which are merged in chunk order at the end.
+inline RatingTotals aggregateRatings(const MappedFile& file, const std::vector<int>& denseOf,
+                                     const std::size_t denseCount, ThreadPool& pool) {
+    const std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+    const auto chunks = splitLines(skipFirstLine(text), pool.size());
+
+    std::vector<std::vector<double>> sums(chunks.size());
+    std::vector<std::vector<std::uint32_t>> counts(chunks.size());
+    std::vector<std::size_t> rows(chunks.size(), 0);
+
+    pool.parallelFor(static_cast<int>(chunks.size()), [&](const int begin, const int end) {
+        for (int c = begin; c < end; ++c) {
+            sums[c].assign(denseCount, 0.0);
+            counts[c].assign(denseCount, 0);
+            double* sum = sums[c].data();
+            std::uint32_t* count = counts[c].data();
+            rows[c] = movielens_detail::forEachRating(chunks[c], [&](std::string_view, const int movieId, const double rating) {
+                if (const int dense = movielens_detail::denseIndex(denseOf, movieId); dense >= 0) {
+                    sum[dense] += rating;
+                    ++count[dense];
+                }
+            });
+        }
+    }, 1);
+
+    RatingTotals totals;
+    totals.sum.assign(denseCount, 0.0);
+    totals.count.assign(denseCount, 0);
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        for (std::size_t i = 0; i < denseCount; ++i) {
+            totals.sum[i] += sums[c][i];
+            totals.count[i] += counts[c][i];
+        }
+        totals.rows += rows[c];
+    }
+    return totals;
+}
+
+// maxMovies > 0 keeps only the first maxMovies rows of movies.csv.
+// MovieLens ratings (0.5-5 stars) are doubled to match TMDB's 0-10 scale.
+// Without links.csv, the MovieLens movieId stands in for the TMDB id; with
+// it, movies that have no TMDB id are skipped.
+inline MovieLensData loadMovieLens(const std::string& dir, ThreadPool& pool, const std::size_t maxMovies = 0) {
+    using namespace movielens_detail;
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::high_resolution_clock;
+
+    MovieLensData data;
+    auto& stats = data.stats;
+
+    auto start = Clock::now();
+    const MappedFile moviesFile((fs::path(dir) / "movies.csv").string());
+    auto movieChunks = parseChunks<std::vector<MovieRow>>(moviesFile, pool,
+        [](const std::string_view chunk, std::vector<MovieRow>& out) {
+            CsvCursor csv(chunk);
+            std::string scratch;
+            while (!csv.done()) {
+                MovieRow row{};
+                const bool ok = parseNumber(csv.field(scratch), row.movieId);
+                if (ok) {
+                    splitTitleYear(csv.field(scratch), row.movie);
+                    splitGenres(csv.field(scratch), row.movie);
+                    out.push_back(std::move(row));
+                }
+                csv.nextLine();
+            }
+        });
+
+    std::vector<MovieRow> rows;
+    for (auto& chunk : movieChunks) {
+        stats.movies.rows += chunk.size();
+        for (auto& row : chunk) rows.push_back(std::move(row));
+    }
+    if (maxMovies > 0 && rows.size() > maxMovies) rows.resize(maxMovies);
+    stats.movies.ms = elapsedMs(start);
+
+    // MovieLens ids are small and fairly dense, so a flat table maps them to
+    // row indexes.
+    int maxMovieId = 0;
+    for (const auto& row : rows) maxMovieId = std::max(maxMovieId, row.movieId);
+    std::vector<int> rowOf(static_cast<std::size_t>(maxMovieId) + 1, -1);
+    for (std::size_t i = rows.size(); i-- > 0;) {
+        if (rows[i].movieId >= 0) rowOf[rows[i].movieId] = static_cast<int>(i);
+    }
+    auto rowIndex = [&](const int movieId) {
+        return movieId >= 0 && movieId <= maxMovieId ? rowOf[movieId] : -1;
+    };
+
+    const fs::path linksPath = fs::path(dir) / "links.csv";
+    const bool haveLinks = fs::exists(linksPath);
+    std::vector<int> tmdbIds(rows.size(), 0);
+    if (haveLinks) {
+        start = Clock::now();
+        const MappedFile linksFile(linksPath.string());
+        const auto linkChunks = parseChunks<std::vector<std::pair<int, int>>>(linksFile, pool,
+            [](const std::string_view chunk, std::vector<std::pair<int, int>>& out) {
+                CsvCursor csv(chunk);
+                std::string scratch;
+                while (!csv.done()) {
+                    int movieId = 0;
+                    int tmdbId = 0;
+                    const bool ok = parseNumber(csv.field(scratch), movieId);
+                    csv.field(scratch);
+                    if (ok && parseNumber(csv.field(scratch), tmdbId)) out.emplace_back(movieId, tmdbId);
+                    csv.nextLine();
+                }
+            });
+        for (const auto& chunk : linkChunks) {
+            stats.links.rows += chunk.size();
+            for (const auto& [movieId, tmdbId] : chunk) {
+                if (const int i = rowIndex(movieId); i >= 0) tmdbIds[i] = tmdbId;
+            }
+        }
+        stats.links.ms = elapsedMs(start);
+    }
+
+    const fs::path ratingsPath = fs::path(dir) / "ratings.csv";
+    RatingTotals ratings;
+    if (fs::exists(ratingsPath)) {
+        start = Clock::now();
+        const MappedFile ratingsFile(ratingsPath.string());
+        ratings = aggregateRatings(ratingsFile, rowOf, rows.size(), pool);
+        stats.ratings.rows = ratings.rows;
+        stats.ratings.ms = elapsedMs(start);
+    } else {
+        ratings.sum.assign(rows.size(), 0.0);
+        ratings.count.assign(rows.size(), 0);
+    }
+
+    data.movies.reserve(rows.size());
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        Movie& m = rows[i].movie;
+        m.tmdbId = haveLinks ? tmdbIds[i] : rows[i].movieId;
+        if (m.tmdbId <= 0) {
+            ++stats.skippedWithoutTmdbId;
+            continue;
+        }
+        m.rating = ratings.count[i] > 0 ? 2.0 * ratings.sum[i] / static_cast<double>(ratings.count[i]) : 0.0;
+        data.movies.push_back(std::move(m));
+        data.movieLensIds.push_back(rows[i].movieId);
+    }
+    return data;
+}
+
+// Reads ratings.csv into a user x item matrix for collaborative filtering.
+// itemOf maps a MovieLens movieId to an item in [0, items), or -1 to ignore
+// it. Ratings keep the 0.5-5 star scale.
+//
+// A first pass only counts the ratings that will be kept, so the staged
+// triples and the matrix built from them can be checked against
+// memoryBudgetBytes (0 for no limit) before anything is allocated; too small
+// a budget throws. The staging buffers are then sized exactly.
+inline RatingMatrix loadRatingMatrix(const std::string& dir, const std::vector<int>& itemOf, const int items,
+                                     const std::size_t minRatingsPerItem, ThreadPool& pool,
+                                     const std::size_t memoryBudgetBytes = 0) {
+    const MappedFile file((std::filesystem::path(dir) / "ratings.csv").string());
+    const std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+    const auto chunks = splitLines(skipFirstLine(text), static_cast<std::size_t>(pool.size()) * 4);
+
+    // Calls fn(chunk, user, item, rating) for every rating of a known movie.
+    auto forEachKept = [&](const auto& fn) {
+        pool.parallelFor(static_cast<int>(chunks.size()), [&](const int begin, const int end) {
+            for (int c = begin; c < end; ++c) {
+                movielens_detail::forEachRating(chunks[c], [&](const std::string_view userField, const int movieId,
+                                                               const double rating) {
+                    std::uint32_t user = 0;
+                    if (!parseNumber(userField, user)) return;
+                    if (const int item = movielens_detail::denseIndex(itemOf, movieId); item >= 0) {
+                        fn(c, user, item, rating);
+                    }
+                });
+            }
+        }, 1);
+    };
+
+    std::vector<std::size_t> kept(chunks.size(), 0);
+    std::vector<std::uint32_t> maxUser(chunks.size(), 0);
+    forEachKept([&](const int c, const std::uint32_t user, int, double) {
+        ++kept[c];
+        maxUser[c] = std::max(maxUser[c], user);
+    });
+
+    const std::uint32_t users = chunks.empty() ? 0 : *std::ranges::max_element(maxUser) + 1;
+    const std::size_t ratings = std::accumulate(kept.begin(), kept.end(), std::size_t{0});
+    if (const std::size_t needed = ratings * sizeof(RatingTriple)
+                                 + RatingMatrix::bytesFor(ratings, static_cast<int>(users), items);
+        memoryBudgetBytes != 0 && needed > memoryBudgetBytes) {
+        throw std::runtime_error("loadRatingMatrix: " + std::to_string(ratings) + " ratings need "
+                                 + std::to_string(needed) + " bytes, over the memory budget of "
+                                 + std::to_string(memoryBudgetBytes));
+    }
+
+    std::vector<std::vector<RatingTriple>> triples(chunks.size());
+    for (std::size_t c = 0; c < chunks.size(); ++c) triples[c].reserve(kept[c]);
+    forEachKept([&](const int c, const std::uint32_t user, const int item, const double rating) {
+        triples[c].push_back(RatingTriple{user, item, static_cast<float>(rating)});
+    });
+
+    return {triples, static_cast<int>(users), items, minRatingsPerItem};
+}
+
+inline MovieLensData loadMovieLens(const std::string& dir, const std::size_t maxMovies = 0,
+                                   const unsigned threads = defaultThreadCount()) {
+    ThreadPool pool(threads);
+    return loadMovieLens(dir, pool, maxMovies);
+}
+
+
+#endif //MOVIERECOMMENDER_MOVIELENS_H
\ No newline at end of file
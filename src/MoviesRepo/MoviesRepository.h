@@ -1,23 +1,182 @@
 #ifndef MOVIERECOMMENDER_MOVIESREPOSITORY_H
 #define MOVIERECOMMENDER_MOVIESREPOSITORY_H
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <list>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
 #include "ImdbAPI/ImdbAPI.h"
 
+struct MoviesRepositoryStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    // Distinct ids requested from the API; misses above this were served by
+    // a fetch already in flight (a duplicate id or another thread's request).
+    std::size_t fetched = 0;
+    std::size_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
 
+    [[nodiscard]] double hitRate() const {
+        const std::size_t total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
 
+// LRU cache of TMDb movie details, bounded by entry count and by estimated
+// bytes, shared by any number of query threads. Movies are returned by value,
+// so an eviction never invalidates what a caller holds. Misses are fetched
+// outside the lock, in one concurrent batch per call; an id that is already
+// being fetched is waited for rather than requested again.
 class MoviesRepository {
 public:
-    explicit MoviesRepository(TmdbAPI& api) : api(api) {}
+    static constexpr std::size_t DEFAULT_MAX_ENTRIES = 4096;
+    static constexpr std::size_t DEFAULT_MAX_BYTES = std::size_t{16} << 20;
+
+    // A limit of 0 turns that bound off.
+    explicit MoviesRepository(TmdbAPI& api,
+                              const std::size_t maxEntries = DEFAULT_MAX_ENTRIES,
+                              const std::size_t maxBytes = DEFAULT_MAX_BYTES)
+        : api(api), maxEntries(maxEntries), maxBytes(maxBytes) {}
+
+    Movie getMovie(const int tmdbId) {
+        return std::move(getMovies(std::span(&tmdbId, 1)).front());
+    }
+
+    // Movies for tmdbIds, in the same order. If the batch fetch fails, this
+    // and every caller waiting on one of its ids gets the exception, and
+    // nothing from the batch is cached.
+    std::vector<Movie> getMovies(const std::span<const int> tmdbIds) {
+        std::vector<Movie> out(tmdbIds.size());
+        std::vector<std::pair<std::size_t, std::shared_future<Movie>>> waits;
+        std::vector<int> toFetch;
+        std::vector<std::promise<Movie>> promises;
+
+        {
+            const std::lock_guard lock(mutex);
+            for (std::size_t i = 0; i < tmdbIds.size(); ++i) {
+                const int id = tmdbIds[i];
+                if (const auto it = index.find(id); it != index.end()) {
+                    ++stats.hits;
+                    entries.splice(entries.begin(), entries, it->second);
+                    out[i] = it->second->movie;
+                    continue;
+                }
+
+                ++stats.misses;
+                auto pending = inFlight.find(id);
+                if (pending == inFlight.end()) {
+                    promises.emplace_back();
+                    toFetch.push_back(id);
+                    pending = inFlight.emplace(id, promises.back().get_future().share()).first;
+                }
+                waits.emplace_back(i, pending->second);
+            }
+            stats.fetched += toFetch.size();
+        }
+
+        if (!toFetch.empty()) {
+            std::vector<Movie> fetched;
+            try {
+                fetched = api.fetchMoviesByIds(toFetch);
+            } catch (...) {
+                const std::exception_ptr error = std::current_exception();
+                {
+                    const std::lock_guard lock(mutex);
+                    for (const int id : toFetch) inFlight.erase(id);
+                }
+                for (auto& p : promises) p.set_exception(error);
+                throw;
+            }
+
+            {
+                const std::lock_guard lock(mutex);
+                for (std::size_t j = 0; j < toFetch.size(); ++j) {
+                    insert(toFetch[j], fetched[j]);
+                    inFlight.erase(toFetch[j]);
+                }
+                evictToFit();
+            }
+            for (std::size_t j = 0; j < toFetch.size(); ++j) {
+                promises[j].set_value(std::move(fetched[j]));
+            }
+        }
+
+        for (auto& [i, movie] : waits) out[i] = movie.get();
+        return out;
+    }
 
-    const Movie& getMovie(int tmdbId) {
-        if (const auto it = cache.find(tmdbId); it != cache.end()) return it->second;
+    void clear() {
+        const std::lock_guard lock(mutex);
+        entries.clear();
+        index.clear();
+        stats.entries = 0;
+        stats.bytes = 0;
+    }
 
-        Movie m = api.fetchMovieById(tmdbId);
-        auto [pos, _] = cache.emplace(tmdbId, std::move(m));
-        return pos->second;
+    [[nodiscard]] MoviesRepositoryStats getStats() const {
+        const std::lock_guard lock(mutex);
+        return stats;
     }
+
 private:
+    struct Entry {
+        int tmdbId;
+        Movie movie;
+        std::size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    // List node, hash node and bucket pointers on top of the strings.
+    static std::size_t entryBytes(const Entry& e) {
+        std::size_t bytes = sizeof(Entry) + 4 * sizeof(void*)
+                            + sizeof(std::pair<const int, EntryList::iterator>)
+                            + e.movie.name.capacity()
+                            + e.movie.genres.capacity() * sizeof(std::string);
+        for (const auto& genre : e.movie.genres) bytes += genre.capacity();
+        return bytes;
+    }
+
+    void insert(const int tmdbId, const Movie& movie) {
+        if (const auto it = index.find(tmdbId); it != index.end()) {
+            stats.bytes -= it->second->bytes;
+            entries.erase(it->second);
+            index.erase(it);
+        }
+
+        Entry entry{tmdbId, movie, 0};
+        entry.bytes = entryBytes(entry);
+        stats.bytes += entry.bytes;
+        entries.push_front(std::move(entry));
+        index.emplace(tmdbId, entries.begin());
+    }
+
+    void evictToFit() {
+        while (!entries.empty()
+               && ((maxEntries != 0 && entries.size() > maxEntries)
+                   || (maxBytes != 0 && stats.bytes > maxBytes))) {
+            const Entry& last = entries.back();
+            stats.bytes -= last.bytes;
+            index.erase(last.tmdbId);
+            entries.pop_back();
+            ++stats.evictions;
+        }
+        stats.entries = entries.size();
+    }
+
     TmdbAPI& api;
-    std::unordered_map<int, Movie> cache;
+    std::size_t maxEntries;
+    std::size_t maxBytes;
+
+    mutable std::mutex mutex;
+    EntryList entries;
+    std::unordered_map<int, EntryList::iterator> index;
+    std::unordered_map<int, std::shared_future<Movie>> inFlight;
+    MoviesRepositoryStats stats;
 };
 
 
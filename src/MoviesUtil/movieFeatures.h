@@ -0,0 +1,89 @@
+#ifndef MOVIERECOMMENDER_MOVIEFEATURES_H
+#define MOVIERECOMMENDER_MOVIEFEATURES_H
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../MoviesUtil/Movie.h"
+
+// The parts of a Movie that similarityScore looks at, with the genre list
+// packed into a bitmask (bit i = genre interned as i).
+struct MovieFeatures {
+    std::uint64_t genreMask = 0;
+    double rating = 0.0;
+    int year = 0;
+};
+
+class GenreTable {
+public:
+    static constexpr int MAX_GENRES = 64;
+
+    int intern(const std::string& name) {
+        if (const auto it = ids.find(name); it != ids.end()) {
+            return it->second;
+        }
+        if (static_cast<int>(names.size()) >= MAX_GENRES) {
+            throw std::runtime_error("GenreTable: more than 64 distinct genres, cannot add '" + name + "'");
+        }
+        const int id = static_cast<int>(names.size());
+        names.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+
+    std::uint64_t maskOf(const std::vector<std::string>& genres) {
+        std::uint64_t mask = 0;
+        for (const auto& g : genres) {
+            mask |= std::uint64_t{1} << intern(g);
+        }
+        return mask;
+    }
+
+    [[nodiscard]] const std::vector<std::string>& getNames() const { return names; }
+
+private:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> ids;
+};
+
+inline MovieFeatures makeFeatures(const Movie& m, GenreTable& genres) {
+    return {genres.maskOf(m.genres), m.rating, m.year};
+}
+
+// MovieFeatures for a whole catalogue stored column by column, so the batch
+// similarity kernels can stream each field with vector loads.
+class FeatureTable {
+public:
+    void push_back(const MovieFeatures& f) {
+        genreMask.push_back(f.genreMask);
+        rating.push_back(f.rating);
+        year.push_back(f.year);
+    }
+
+    void clear() {
+        genreMask.clear();
+        rating.clear();
+        year.clear();
+    }
+
+    [[nodiscard]] MovieFeatures operator[](const std::size_t i) const {
+        return {genreMask[i], rating[i], year[i]};
+    }
+
+    [[nodiscard]] std::size_t size() const { return genreMask.size(); }
+    [[nodiscard]] bool empty() const { return genreMask.empty(); }
+
+    [[nodiscard]] const std::uint64_t* genreMasks() const { return genreMask.data(); }
+    [[nodiscard]] const double* ratings() const { return rating.data(); }
+    [[nodiscard]] const int* years() const { return year.data(); }
+
+private:
+    std::vector<std::uint64_t> genreMask;
+    std::vector<double> rating;
+    std::vector<int> year;
+};
+
+
+#endif //MOVIERECOMMENDER_MOVIEFEATURES_H
\ No newline at end of file
@@ -0,0 +1,227 @@
+#ifndef MOVIERECOMMENDER_SIMILARITYBATCH_H
+#define MOVIERECOMMENDER_SIMILARITYBATCH_H
+#include <cstddef>
+#include <cstdint>
+#include "../MoviesUtil/movieFeatures.h"
+#include "../MoviesUtil/similarityScore.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MOVIERECOMMENDER_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// One-vs-many similarity: scores a source movie against rows [begin, end) of
+// a FeatureTable and writes one score per row to out[0 .. end - begin).
+// Every ISA performs the same IEEE operations in the same order as
+// similarityScore(MovieFeatures, MovieFeatures), so results match exactly.
+
+enum class SimdIsa { Scalar, AVX2, AVX512 };
+
+inline const char* simdIsaName(const SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::AVX2:   return "AVX2";
+        case SimdIsa::AVX512: return "AVX-512";
+        default:              return "Scalar";
+    }
+}
+
+inline bool simdIsaSupported(const SimdIsa isa) {
+#ifdef MOVIERECOMMENDER_X86_SIMD
+    switch (isa) {
+        case SimdIsa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case SimdIsa::AVX512:
+            return __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("avx512dq") &&
+                   __builtin_cpu_supports("avx512vpopcntdq");
+        default:
+            return true;
+    }
+#else
+    return isa == SimdIsa::Scalar;
+#endif
+}
+
+inline SimdIsa bestSimdIsa() {
+    static const SimdIsa best = simdIsaSupported(SimdIsa::AVX512) ? SimdIsa::AVX512
+                              : simdIsaSupported(SimdIsa::AVX2)   ? SimdIsa::AVX2
+                                                                  : SimdIsa::Scalar;
+    return best;
+}
+
+inline void scoreBatchScalar(const MovieFeatures& src, const FeatureTable& table,
+                             const std::size_t begin, const std::size_t end, double* out) {
+    for (std::size_t j = begin; j < end; ++j) {
+        out[j - begin] = similarityScore(src, table[j]);
+    }
+}
+
+#ifdef MOVIERECOMMENDER_X86_SIMD
+
+__attribute__((target("avx2")))
+inline __m256i popcount64Avx2(const __m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_and_si256(v, lowNibble);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                          _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+// Low 32 bits of each 64-bit lane (small counts) as four doubles.
+__attribute__((target("avx2")))
+inline __m256d small64ToDoubleAvx2(const __m256i v) {
+    const __m256i packed = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0));
+    return _mm256_cvtepi32_pd(_mm256_castsi256_si128(packed));
+}
+
+__attribute__((target("avx2")))
+inline void scoreBatchAvx2(const MovieFeatures& src, const FeatureTable& table,
+                           const std::size_t begin, const std::size_t end, double* out) {
+    const std::uint64_t* masks = table.genreMasks();
+    const double* ratings = table.ratings();
+    const int* years = table.years();
+
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d wGenre = _mm256_set1_pd(0.7);
+    const __m256d wRating = _mm256_set1_pd(0.2);
+    const __m256d wYear = _mm256_set1_pd(0.1);
+    const __m256d cutoff = _mm256_set1_pd(0.15);
+
+    const __m256i srcMask = _mm256_set1_epi64x(static_cast<long long>(src.genreMask));
+    const __m256d srcRating = _mm256_set1_pd(src.rating);
+    const __m256d srcYear = _mm256_set1_pd(static_cast<double>(src.year));
+    const __m256d srcHasGenres = src.genreMask != 0 ? _mm256_castsi256_pd(_mm256_set1_epi64x(-1)) : zero;
+    const __m256d srcHasRating = src.rating > 0.0 ? _mm256_castsi256_pd(_mm256_set1_epi64x(-1)) : zero;
+    const __m256d srcHasYear = src.year > 0 ? _mm256_castsi256_pd(_mm256_set1_epi64x(-1)) : zero;
+
+    std::size_t j = begin;
+    for (; j + 4 <= end; j += 4) {
+        const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + j));
+        const __m256d rating = _mm256_loadu_pd(ratings + j);
+        const __m256d year = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(years + j)));
+
+        // ---------- Genre similarity ----------
+        const __m256d inter = small64ToDoubleAvx2(popcount64Avx2(_mm256_and_si256(srcMask, mask)));
+        const __m256d uni = small64ToDoubleAvx2(popcount64Avx2(_mm256_or_si256(srcMask, mask)));
+        const __m256d candHasGenres = _mm256_castsi256_pd(
+            _mm256_xor_si256(_mm256_cmpeq_epi64(mask, _mm256_setzero_si256()), _mm256_set1_epi64x(-1)));
+        const __m256d hasGenres = _mm256_and_pd(srcHasGenres, candHasGenres);
+        const __m256d disjoint = _mm256_and_pd(hasGenres, _mm256_cmp_pd(inter, zero, _CMP_EQ_OQ));
+
+        const __m256d genreSim = _mm256_div_pd(inter, uni);
+        __m256d score = _mm256_and_pd(hasGenres, _mm256_mul_pd(wGenre, genreSim));
+        __m256d weightSum = _mm256_and_pd(hasGenres, wGenre);
+
+        // ---------- Rating similarity ----------
+        const __m256d hasRating = _mm256_and_pd(srcHasRating, _mm256_cmp_pd(rating, zero, _CMP_GT_OQ));
+        const __m256d rDiff = _mm256_andnot_pd(signMask, _mm256_sub_pd(srcRating, rating));
+        const __m256d rSim = _mm256_max_pd(_mm256_sub_pd(one, _mm256_div_pd(rDiff, _mm256_set1_pd(1.5))), zero);
+        score = _mm256_add_pd(score, _mm256_and_pd(hasRating, _mm256_mul_pd(wRating, rSim)));
+        weightSum = _mm256_add_pd(weightSum, _mm256_and_pd(hasRating, wRating));
+
+        // ---------- Year similarity ----------
+        const __m256d hasYear = _mm256_and_pd(srcHasYear, _mm256_cmp_pd(year, zero, _CMP_GT_OQ));
+        const __m256d yDiff = _mm256_andnot_pd(signMask, _mm256_sub_pd(srcYear, year));
+        const __m256d ySim = _mm256_max_pd(_mm256_sub_pd(one, _mm256_div_pd(yDiff, _mm256_set1_pd(12.0))), zero);
+        score = _mm256_add_pd(score, _mm256_and_pd(hasYear, _mm256_mul_pd(wYear, ySim)));
+        weightSum = _mm256_add_pd(weightSum, _mm256_and_pd(hasYear, wYear));
+
+        const __m256d finalSim = _mm256_div_pd(score, weightSum);
+        const __m256d keep = _mm256_andnot_pd(disjoint, _mm256_and_pd(
+            _mm256_cmp_pd(weightSum, zero, _CMP_NEQ_OQ), _mm256_cmp_pd(finalSim, cutoff, _CMP_GE_OQ)));
+
+        _mm256_storeu_pd(out + (j - begin), _mm256_and_pd(keep, finalSim));
+    }
+
+    scoreBatchScalar(src, table, j, end, out + (j - begin));
+}
+
+__attribute__((target("avx512f,avx512dq,avx512vpopcntdq")))
+inline void scoreBatchAvx512(const MovieFeatures& src, const FeatureTable& table,
+                             const std::size_t begin, const std::size_t end, double* out) {
+    const std::uint64_t* masks = table.genreMasks();
+    const double* ratings = table.ratings();
+    const int* years = table.years();
+
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d wGenre = _mm512_set1_pd(0.7);
+    const __m512d wRating = _mm512_set1_pd(0.2);
+    const __m512d wYear = _mm512_set1_pd(0.1);
+    const __m512d cutoff = _mm512_set1_pd(0.15);
+    // Full-width maskz forms: the unmasked ones trip a GCC 12
+    // -Wmaybe-uninitialized false positive inside the intrinsic headers.
+    constexpr __mmask8 all = 0xff;
+
+    const __m512i srcMask = _mm512_set1_epi64(static_cast<long long>(src.genreMask));
+    const __m512d srcRating = _mm512_set1_pd(src.rating);
+    const __m512d srcYear = _mm512_set1_pd(static_cast<double>(src.year));
+    const __mmask8 srcHasGenres = src.genreMask != 0 ? 0xff : 0;
+    const __mmask8 srcHasRating = src.rating > 0.0 ? 0xff : 0;
+    const __mmask8 srcHasYear = src.year > 0 ? 0xff : 0;
+
+    std::size_t j = begin;
+    for (; j + 8 <= end; j += 8) {
+        const __m512i mask = _mm512_loadu_si512(masks + j);
+        const __m512d rating = _mm512_loadu_pd(ratings + j);
+        const __m512d year = _mm512_maskz_cvtepi32_pd(all, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(years + j)));
+
+        // ---------- Genre similarity ----------
+        const __m512d inter = _mm512_cvtepi64_pd(_mm512_popcnt_epi64(_mm512_and_si512(srcMask, mask)));
+        const __m512d uni = _mm512_cvtepi64_pd(_mm512_popcnt_epi64(_mm512_or_si512(srcMask, mask)));
+        const __mmask8 hasGenres = srcHasGenres & _mm512_test_epi64_mask(mask, mask);
+        const __mmask8 disjoint = hasGenres & _mm512_cmp_pd_mask(inter, zero, _CMP_EQ_OQ);
+
+        const __m512d genreSim = _mm512_div_pd(inter, uni);
+        __m512d score = _mm512_maskz_mul_pd(hasGenres, wGenre, genreSim);
+        __m512d weightSum = _mm512_maskz_mov_pd(hasGenres, wGenre);
+
+        // ---------- Rating similarity ----------
+        const __mmask8 hasRating = srcHasRating & _mm512_cmp_pd_mask(rating, zero, _CMP_GT_OQ);
+        const __m512d rDiff = _mm512_abs_pd(_mm512_sub_pd(srcRating, rating));
+        const __m512d rSim = _mm512_maskz_max_pd(all, _mm512_sub_pd(one, _mm512_div_pd(rDiff, _mm512_set1_pd(1.5))), zero);
+        score = _mm512_mask_add_pd(score, hasRating, score, _mm512_mul_pd(wRating, rSim));
+        weightSum = _mm512_mask_add_pd(weightSum, hasRating, weightSum, wRating);
+
+        // ---------- Year similarity ----------
+        const __mmask8 hasYear = srcHasYear & _mm512_cmp_pd_mask(year, zero, _CMP_GT_OQ);
+        const __m512d yDiff = _mm512_abs_pd(_mm512_sub_pd(srcYear, year));
+        const __m512d ySim = _mm512_maskz_max_pd(all, _mm512_sub_pd(one, _mm512_div_pd(yDiff, _mm512_set1_pd(12.0))), zero);
+        score = _mm512_mask_add_pd(score, hasYear, score, _mm512_mul_pd(wYear, ySim));
+        weightSum = _mm512_mask_add_pd(weightSum, hasYear, weightSum, wYear);
+
+        const __m512d finalSim = _mm512_div_pd(score, weightSum);
+        const __mmask8 keep = static_cast<__mmask8>(~disjoint) &
+                              _mm512_cmp_pd_mask(weightSum, zero, _CMP_NEQ_OQ) &
+                              _mm512_cmp_pd_mask(finalSim, cutoff, _CMP_GE_OQ);
+
+        _mm512_storeu_pd(out + (j - begin), _mm512_maskz_mov_pd(keep, finalSim));
+    }
+
+    scoreBatchScalar(src, table, j, end, out + (j - begin));
+}
+
+#endif
+
+inline void scoreBatch(const MovieFeatures& src, const FeatureTable& table,
+                       const std::size_t begin, const std::size_t end, double* out,
+                       const SimdIsa isa = bestSimdIsa()) {
+#ifdef MOVIERECOMMENDER_X86_SIMD
+    switch (isa) {
+        case SimdIsa::AVX512: return scoreBatchAvx512(src, table, begin, end, out);
+        case SimdIsa::AVX2:   return scoreBatchAvx2(src, table, begin, end, out);
+        default: break;
+    }
+#else
+    (void)isa;
+#endif
+    scoreBatchScalar(src, table, begin, end, out);
+}
+
+
+#endif //MOVIERECOMMENDER_SIMILARITYBATCH_H
\ No newline at end of file
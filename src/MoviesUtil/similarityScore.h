@@ -1,10 +1,53 @@
 #ifndef MOVIERECOMMENDER_SIMILARITYSCORE_H
 #define MOVIERECOMMENDER_SIMILARITYSCORE_H
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <iostream>
 #include <unordered_set>
 #include "../MoviesUtil/Movie.h"
+#include "../MoviesUtil/movieFeatures.h"
 
 
+// Folds rating and year similarity into the genre part and applies the
+// cut-off. Shared by both similarityScore overloads so they agree bit for bit.
+inline double combineSimilarity(double score, double weightSum,
+                                const double ratingA, const double ratingB,
+                                const int yearA, const int yearB) {
+    // ---------- Rating similarity ----------
+    if (ratingA > 0.0 && ratingB > 0.0) {
+        const double diff = std::fabs(ratingA - ratingB);
+        const double rSim = std::max(0.0, 1.0 - diff / 1.5);
+
+        constexpr double wRating = 0.2;
+        score += wRating * rSim;
+        weightSum += wRating;
+    }
+
+    // ---------- Year similarity ----------
+    if (yearA > 0 && yearB > 0) {
+        const int diff = std::abs(yearA - yearB);
+
+        const double ySim = std::max(0.0, 1.0 - static_cast<double>(diff) / 12.0);
+
+        constexpr double wYear = 0.1;
+        score += wYear * ySim;
+        weightSum += wYear;
+    }
+
+    if (weightSum == 0.0) {
+        return 0.0;
+    }
+
+    const double finalSim = score / weightSum;
+
+    if (finalSim < 0.15) {
+        return 0.0;
+    }
+
+    return finalSim;
+}
+
 inline double similarityScore(const Movie& a, const Movie& b) {
     double score = 0.0;
     double weightSum = 0.0;
@@ -31,38 +74,31 @@ inline double similarityScore(const Movie& a, const Movie& b) {
         weightSum += wGenre;
     }
 
-    // ---------- Rating similarity ----------
-    if (a.rating > 0.0 && b.rating > 0.0) {
-        const double diff = std::fabs(a.rating - b.rating);
-        const double rSim = std::max(0.0, 1.0 - diff / 1.5);
-
-        constexpr double wRating = 0.2;
-        score += wRating * rSim;
-        weightSum += wRating;
-    }
-
-    // ---------- Year similarity ----------
-    if (a.year > 0 && b.year > 0) {
-        const int diff = std::abs(a.year - b.year);
-
-        const double ySim = std::max(0.0, 1.0 - static_cast<double>(diff) / 12.0);
+    return combineSimilarity(score, weightSum, a.rating, b.rating, a.year, b.year);
+}
 
-        constexpr double wYear = 0.1;
-        score += wYear * ySim;
-        weightSum += wYear;
-    }
+// Same score as above from precomputed features: genre Jaccard is
+// popcount(a & b) / popcount(a | b). Genre lists are treated as sets, which
+// is what they are in practice.
+inline double similarityScore(const MovieFeatures& a, const MovieFeatures& b) {
+    double score = 0.0;
+    double weightSum = 0.0;
 
-    if (weightSum == 0.0) {
-        return 0.0;
-    }
+    if (a.genreMask != 0 && b.genreMask != 0) {
+        const int inter = std::popcount(a.genreMask & b.genreMask);
+        if (inter == 0) {
+            return 0.0;
+        }
 
-    const double finalSim = score / weightSum;
+        const int uni = std::popcount(a.genreMask | b.genreMask);
+        const double genreSim = static_cast<double>(inter) / uni;
 
-    if (finalSim < 0.15) {
-        return 0.0;
+        constexpr double wGenre = 0.7;
+        score += wGenre * genreSim;
+        weightSum += wGenre;
     }
 
-    return finalSim;
+    return combineSimilarity(score, weightSum, a.rating, b.rating, a.year, b.year);
 }
 
 inline double weightFromSimilarity(const double similarity) {
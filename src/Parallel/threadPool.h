@@ -0,0 +1,112 @@
+#ifndef MOVIERECOMMENDER_THREADPOOL_H
+#define MOVIERECOMMENDER_THREADPOOL_H
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+inline unsigned defaultThreadCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Fixed set of worker threads fed from one task queue. parallelFor() must not
+// be called from inside a task running on the same pool.
+class ThreadPool {
+public:
+    explicit ThreadPool(const unsigned threads = defaultThreadCount()) {
+        const unsigned count = std::max(1u, threads);
+        workers.reserve(count);
+        for (unsigned i = 0; i < count; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(mutex);
+            tasks.push(std::move(task));
+        }
+        wake.notify_one();
+    }
+
+    // Calls fn(begin, end) over [0, n) in chunks of `grain`, handed out
+    // dynamically to the workers. Blocks until every chunk is done and
+    // rethrows the first exception a chunk threw.
+    template <class Fn>
+    void parallelFor(const int n, Fn&& fn, const int grain = 64) {
+        if (n <= 0) return;
+
+        const int chunks = (n + grain - 1) / grain;
+        const int used = std::min(static_cast<int>(size()), chunks);
+        if (used <= 1) {
+            fn(0, n);
+            return;
+        }
+
+        std::atomic<int> next{0};
+        std::latch done(used);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        for (int w = 0; w < used; ++w) {
+            submit([&] {
+                try {
+                    for (int begin = next.fetch_add(grain); begin < n; begin = next.fetch_add(grain)) {
+                        fn(begin, std::min(n, begin + grain));
+                    }
+                } catch (...) {
+                    std::lock_guard lock(errorMutex);
+                    if (!error) error = std::current_exception();
+                }
+                done.count_down();
+            });
+        }
+
+        done.wait();
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+
+#endif //MOVIERECOMMENDER_THREADPOOL_H
\ No newline at end of file